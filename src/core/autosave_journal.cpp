@@ -0,0 +1,577 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#include "autosave_journal.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <unordered_set>
+#include <utility>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QScopeGuard>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include "core/map.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/symbols/symbol.h"
+#include "undo/object_undo.h"
+#include "undo/undo.h"
+#include "undo/undo_manager.h"
+#include "util/xml_stream_util.h"
+
+
+namespace literal
+{
+	const QLatin1String entry("entry");
+	const QLatin1String part("part");
+	const QLatin1String index("index");
+	const QLatin1String objects("objects");
+	const QLatin1String object("object");
+	const QLatin1String keep("keep");
+	const QLatin1String first("first");
+	const QLatin1String count("count");
+}
+
+
+
+namespace LibreMapper {
+
+namespace {
+
+constexpr quint32 journal_magic = 0x4c4d4a4c;  // "LMJL"
+constexpr quint32 journal_version = 2;
+constexpr auto stream_version = QDataStream::Qt_6_0;
+
+/// The hash which identifies the contents of the checkpoint
+constexpr auto checkpoint_hash_algorithm = QCryptographicHash::Sha256;
+constexpr qint64 checkpoint_hash_size = 32;
+
+/// The size of magic, version and checkpoint hash (with its length)
+constexpr qint64 header_size = 3 * sizeof(quint32) + checkpoint_hash_size;
+
+/// A new checkpoint is needed when the journal exceeds this part of the checkpoint size.
+constexpr qint64 max_journal_percentage = 25;
+
+
+qint64 modificationTime(const QFileInfo& info)
+{
+	return info.lastModified().toMSecsSinceEpoch();
+}
+
+
+/**
+ * Returns the hash of the contents of the checkpoint file,
+ * or an empty byte array on error.
+ */
+QByteArray checkpointHash(const QString& checkpoint_path)
+{
+	QFile file(checkpoint_path);
+	QCryptographicHash hash(checkpoint_hash_algorithm);
+	if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file))
+		return {};
+	return hash.result();
+}
+
+
+/**
+ * Collects the non-combined steps in the order in which they are undone.
+ */
+void collectSteps(const UndoStep* step, std::vector<const UndoStep*>& steps)
+{
+	if (step->getType() == UndoStep::CombinedUndoStepType)
+	{
+		auto const* combined_step = static_cast<const CombinedUndoStep*>(step);
+		for (auto i = combined_step->getNumSubSteps(); i > 0; --i)
+			collectSteps(combined_step->getSubStep(i - 1), steps);
+	}
+	else
+	{
+		steps.push_back(step);
+	}
+}
+
+
+/**
+ * The objects of a map part during replay.
+ */
+struct ReplayPart
+{
+	std::vector<Object*> objects;           ///< The objects after the entries replayed so far
+	std::unordered_set<Object*> original;   ///< The objects loaded from the checkpoint
+};
+
+
+/**
+ * Applies a single journal entry to the replay state.
+ * 
+ * The entry is parsed completely before the state is modified.
+ */
+bool applyEntry(Map& map, const QByteArray& record, const SymbolDictionary& symbol_dict, std::map<int, ReplayPart>& parts)
+{
+	struct PartResult
+	{
+		int index;
+		std::vector<Object*> objects;
+		std::vector<bool> kept;
+	};
+	std::vector<PartResult> results;
+	std::vector<Object*> loaded;
+	auto delete_loaded = qScopeGuard([&loaded]() {
+		for (auto* object : loaded)
+			delete object;
+	});
+	
+	QXmlStreamReader xml(record);
+	try
+	{
+		if (!xml.readNextStartElement() || xml.name() != literal::entry)
+			return false;
+		
+		while (xml.readNextStartElement())
+		{
+			if (xml.name() != literal::part)
+			{
+				xml.skipCurrentElement();
+				continue;
+			}
+			
+			XmlElementReader part_element(xml);
+			auto const part_index = part_element.attribute<int>(literal::index);
+			if (part_index < 0 || part_index >= map.getNumParts()
+			    || std::any_of(results.begin(), results.end(), [part_index](auto const& result) { return result.index == part_index; }))
+			{
+				return false;
+			}
+			
+			auto state = parts.find(part_index);
+			if (state == parts.end())
+			{
+				auto* part = map.getPart(std::size_t(part_index));
+				ReplayPart part_state;
+				part_state.objects.reserve(std::size_t(part->getNumObjects()));
+				for (int i = 0; i < part->getNumObjects(); ++i)
+					part_state.objects.push_back(part->getObject(i));
+				part_state.original.insert(part_state.objects.begin(), part_state.objects.end());
+				state = parts.emplace(part_index, std::move(part_state)).first;
+			}
+			auto const& previous = state->second.objects;
+			
+			auto const num_objects = part_element.attribute<int>(literal::objects);
+			PartResult result { part_index, {}, std::vector<bool>(previous.size(), false) };
+			result.objects.reserve(std::size_t(std::max(num_objects, 0)));
+			while (xml.readNextStartElement())
+			{
+				if (xml.name() == literal::keep)
+				{
+					XmlElementReader keep_element(xml);
+					auto const first = keep_element.attribute<int>(literal::first);
+					auto const count = keep_element.attribute<int>(literal::count);
+					if (first < 0 || count < 0 || first > int(previous.size()) - count)
+						return false;
+					for (auto i = std::size_t(first); i < std::size_t(first + count); ++i)
+					{
+						if (result.kept[i])
+							return false;
+						result.kept[i] = true;
+						result.objects.push_back(previous[i]);
+					}
+				}
+				else if (xml.name() == literal::object)
+				{
+					loaded.push_back(Object::load(xml, &map, symbol_dict));
+					result.objects.push_back(loaded.back());
+				}
+				else
+				{
+					xml.skipCurrentElement();
+				}
+			}
+			if (int(result.objects.size()) != num_objects)
+				return false;
+			results.push_back(std::move(result));
+		}
+	}
+	catch (std::exception& e)
+	{
+		qWarning("Cannot replay autosave journal entry: %s", e.what());
+		return false;
+	}
+	if (xml.hasError())
+		return false;
+	
+	for (auto& result : results)
+	{
+		auto& state = parts[result.index];
+		for (std::size_t i = 0; i < result.kept.size(); ++i)
+		{
+			// Objects from the checkpoint are still owned by the map part.
+			auto* object = state.objects[i];
+			if (!result.kept[i] && !state.original.count(object))
+				delete object;
+		}
+		state.objects = std::move(result.objects);
+	}
+	loaded.clear();
+	return true;
+}
+
+
+}  // namespace
+
+
+
+// ### AutosaveJournal ###
+
+AutosaveJournal::AutosaveJournal(Map& map, const QString& checkpoint_path)
+: map(map)
+, checkpoint_path(checkpoint_path)
+{
+	connect(&map.undoManager(), &UndoManager::changeApplied, this, &AutosaveJournal::changeApplied);
+}
+
+AutosaveJournal::~AutosaveJournal() = default;
+
+
+// static
+QString AutosaveJournal::journalPath(const QString& checkpoint_path)
+{
+	return checkpoint_path + QLatin1String(".journal");
+}
+
+
+bool AutosaveJournal::needsCheckpoint() const
+{
+	return checkpoint_needed
+	       || checkpoint_revision != map.nonObjectRevision()
+	       || snapshot.size() != std::size_t(map.getNumParts())
+	       || (journal_size - header_size) * 100 > checkpoint_size * max_journal_percentage
+	       || !filesUnchanged();
+}
+
+
+bool AutosaveJournal::checkpointWritten()
+{
+	checkpoint_needed = true;
+	
+	auto const checkpoint = QFileInfo(checkpoint_path);
+	auto const hash = checkpointHash(checkpoint_path);
+	if (!checkpoint.exists() || hash.size() != checkpoint_hash_size)
+		return false;
+	
+	QFile file(journalPath(checkpoint_path));
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	QDataStream stream(&file);
+	stream.setVersion(stream_version);
+	stream << journal_magic << journal_version << hash;
+	file.close();
+	if (stream.status() != QDataStream::Ok || file.error() != QFileDevice::NoError)
+		return false;
+	
+	snapshot.resize(std::size_t(map.getNumParts()));
+	for (std::size_t i = 0; i < snapshot.size(); ++i)
+	{
+		auto const* part = map.getPart(i);
+		auto& objects = snapshot[i];
+		objects.resize(std::size_t(part->getNumObjects()));
+		for (int j = 0; j < part->getNumObjects(); ++j)
+			objects[std::size_t(j)] = part->getObject(j);
+	}
+	dirty_objects.clear();
+	modified_parts.clear();
+	
+	checkpoint_revision = map.nonObjectRevision();
+	checkpoint_size = checkpoint.size();
+	checkpoint_modified = modificationTime(checkpoint);
+	journal_size = header_size;
+	checkpoint_needed = false;
+	return true;
+}
+
+
+bool AutosaveJournal::append()
+{
+	Q_ASSERT(!needsCheckpoint());
+	
+	if (modified_parts.empty())
+		return true;
+	
+	// Each part is recorded as a sequence of unmodified objects from the
+	// previous state, referenced by index ranges, and of modified objects.
+	QByteArray record;
+	{
+		QXmlStreamWriter xml(&record);
+		XmlElementWriter entry_element(xml, literal::entry);
+		for (auto const part_index : modified_parts)
+		{
+			auto const* part = map.getPart(std::size_t(part_index));
+			auto& objects = snapshot[std::size_t(part_index)];
+			
+			QHash<const Object*, int> previous_index;
+			previous_index.reserve(qsizetype(objects.size()));
+			for (std::size_t i = 0; i < objects.size(); ++i)
+				previous_index.insert(objects[i], int(i));
+			
+			XmlElementWriter part_element(xml, literal::part);
+			part_element.writeAttribute(literal::index, part_index);
+			part_element.writeAttribute(literal::objects, part->getNumObjects());
+			
+			auto first = 0;
+			auto count = 0;
+			auto write_kept = [&xml, &first, &count]() {
+				if (count > 0)
+				{
+					XmlElementWriter keep_element(xml, literal::keep);
+					keep_element.writeAttribute(literal::first, first);
+					keep_element.writeAttribute(literal::count, count);
+					count = 0;
+				}
+			};
+			
+			std::vector<const Object*> current;
+			current.reserve(std::size_t(part->getNumObjects()));
+			for (int i = 0; i < part->getNumObjects(); ++i)
+			{
+				auto const* object = part->getObject(i);
+				current.push_back(object);
+				auto const previous = dirty_objects.count(object) ? previous_index.constEnd() : previous_index.constFind(object);
+				if (previous == previous_index.constEnd())
+				{
+					write_kept();
+					object->save(xml);
+				}
+				else if (count > 0 && *previous == first + count)
+				{
+					++count;
+				}
+				else
+				{
+					write_kept();
+					first = *previous;
+					count = 1;
+				}
+			}
+			write_kept();
+			objects = std::move(current);
+		}
+	}
+	dirty_objects.clear();
+	modified_parts.clear();
+	
+	QFile file(journalPath(checkpoint_path));
+	if (file.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		QDataStream stream(&file);
+		stream.setVersion(stream_version);
+		stream << record << qChecksum(record);
+		file.close();
+		if (stream.status() == QDataStream::Ok && file.error() == QFileDevice::NoError)
+		{
+			journal_size = QFileInfo(file).size();
+			return true;
+		}
+	}
+	
+	// The snapshot no longer matches the journal.
+	checkpoint_needed = true;
+	return false;
+}
+
+
+// static
+bool AutosaveJournal::replay(Map& map, const QString& checkpoint_path)
+{
+	QFile file(journalPath(checkpoint_path));
+	if (!file.exists())
+		return true;
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	
+	QDataStream stream(&file);
+	stream.setVersion(stream_version);
+	quint32 magic, version;
+	QByteArray hash;
+	stream >> magic >> version;
+	if (stream.status() == QDataStream::Ok && magic == journal_magic && version == journal_version)
+		stream >> hash;
+	if (stream.status() != QDataStream::Ok
+	    || magic != journal_magic
+	    || version != journal_version
+	    || hash.size() != checkpoint_hash_size
+	    || hash != checkpointHash(checkpoint_path))
+	{
+		// A journal from an older checkpoint, or from an unknown version
+		return true;
+	}
+	
+	SymbolDictionary symbol_dict;
+	for (int i = 0; i < map.getNumSymbols(); ++i)
+		symbol_dict[i] = map.getSymbol(i);
+	
+	std::map<int, ReplayPart> parts;
+	auto success = true;
+	while (!stream.atEnd())
+	{
+		QByteArray record;
+		quint16 checksum;
+		stream >> record >> checksum;
+		if (stream.status() != QDataStream::Ok || checksum != qChecksum(record))
+			break;  // Incomplete last entry
+		
+		if (!applyEntry(map, record, symbol_dict, parts))
+		{
+			success = false;
+			break;
+		}
+	}
+	if (parts.empty())
+		return success;
+	
+	map.clearObjectSelection(false);
+	for (auto& item : parts)
+	{
+		auto* part = map.getPart(std::size_t(item.first));
+		auto& state = item.second;
+		for (auto i = part->getNumObjects(); i > 0; --i)
+			part->releaseObject(i - 1);
+		for (auto* object : state.objects)
+		{
+			state.original.erase(object);
+			part->addObject(object);
+		}
+		for (auto* object : state.original)
+			delete object;
+	}
+	map.undoManager().clear();
+	return success;
+}
+
+
+// static
+bool AutosaveJournal::remove(const QString& checkpoint_path)
+{
+	QFile file(journalPath(checkpoint_path));
+	return !file.exists() || file.remove();
+}
+
+
+void AutosaveJournal::changeApplied(const UndoStep* reverse_step)
+{
+	if (checkpoint_needed)
+		return;
+	
+	std::vector<const UndoStep*> steps;
+	collectSteps(reverse_step, steps);
+	
+	// The indices in a step refer to the state after undoing the previous
+	// steps. Per part, these maps translate them to current indices.
+	std::map<int, std::vector<int>> index_maps;
+	for (std::size_t i = 0; i < steps.size(); ++i)
+	{
+		auto const type = steps[i]->getType();
+		switch (type)
+		{
+		case UndoStep::ValidNoOpUndoStepType:
+			continue;
+		case UndoStep::ReplaceObjectsUndoStepType:
+		case UndoStep::DeleteObjectsUndoStepType:
+		case UndoStep::AddObjectsUndoStepType:
+		case UndoStep::SwitchSymbolUndoStepType:
+		case UndoStep::SwitchDashesUndoStepType:
+		case UndoStep::ObjectTagsUndoStepType:
+			break;
+		default:
+			// Changes to map parts, or unknown changes
+			checkpoint_needed = true;
+			return;
+		}
+		
+		auto const* step = static_cast<const ObjectModifyingUndoStep*>(steps[i]);
+		auto const part_index = step->getPartIndex();
+		if (part_index < 0 || part_index >= map.getNumParts())
+		{
+			checkpoint_needed = true;
+			return;
+		}
+		modified_parts.insert(part_index);
+		
+		auto const* part = map.getPart(std::size_t(part_index));
+		auto index_map = index_maps.find(part_index);
+		if (type != UndoStep::AddObjectsUndoStepType)
+		{
+			// The objects to be replaced or deleted by this step are modified or new.
+			for (auto index : step->affectedObjects())
+			{
+				if (index_map != index_maps.end())
+					index = (index >= 0 && index < int(index_map->second.size())) ? index_map->second[std::size_t(index)] : -1;
+				if (index >= 0 && index < part->getNumObjects())
+					dirty_objects.insert(part->getObject(index));
+			}
+		}
+		
+		if ((type == UndoStep::AddObjectsUndoStepType || type == UndoStep::DeleteObjectsUndoStepType)
+		    && i + 1 < steps.size())
+		{
+			if (index_map == index_maps.end())
+			{
+				auto identity = std::vector<int>(std::size_t(part->getNumObjects()));
+				std::iota(identity.begin(), identity.end(), 0);
+				index_map = index_maps.emplace(part_index, std::move(identity)).first;
+			}
+			auto& current_index = index_map->second;
+			auto indices = step->affectedObjects();
+			if (type == UndoStep::DeleteObjectsUndoStepType)
+			{
+				std::sort(indices.begin(), indices.end(), std::greater<int>());
+				for (auto index : indices)
+				{
+					if (index >= 0 && index < int(current_index.size()))
+						current_index.erase(current_index.begin() + index);
+				}
+			}
+			else
+			{
+				std::sort(indices.begin(), indices.end());
+				for (auto index : indices)
+				{
+					if (index >= 0 && index <= int(current_index.size()))
+						current_index.insert(current_index.begin() + index, -1);
+				}
+			}
+		}
+	}
+}
+
+
+bool AutosaveJournal::filesUnchanged() const
+{
+	auto const checkpoint = QFileInfo(checkpoint_path);
+	auto const journal = QFileInfo(journalPath(checkpoint_path));
+	return checkpoint.exists()
+	       && checkpoint.size() == checkpoint_size
+	       && modificationTime(checkpoint) == checkpoint_modified
+	       && journal.exists()
+	       && journal.size() == journal_size;
+}
+
+
+}  // namespace LibreMapper
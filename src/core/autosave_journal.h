@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#ifndef LIBREMAPPER_AUTOSAVE_JOURNAL_H
+#define LIBREMAPPER_AUTOSAVE_JOURNAL_H
+
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QString>
+
+namespace LibreMapper {
+
+class Map;
+class Object;
+class UndoStep;
+
+
+/**
+ * An append-only journal of object changes, for incremental autosaving.
+ * 
+ * The journal complements a checkpoint, i.e. a complete copy of the map
+ * written by a regular exporter. append() writes the changes to the objects
+ * since the previous call to the end of the journal file, so its cost
+ * depends on the amount of edits, not on the size of the map. On recovery,
+ * replay() applies the journal to the loaded checkpoint.
+ * 
+ * Object changes are tracked via the steps reported by the map's
+ * UndoManager. Changes which are not covered by object undo steps, such as
+ * changes to colors, symbols or map parts, require a new checkpoint.
+ * A new checkpoint is also required when the journal has grown too big
+ * compared to the checkpoint.
+ * 
+ * The journal header holds a hash of the contents of the checkpoint, so
+ * that a journal is never applied to a different checkpoint.
+ */
+class AutosaveJournal : public QObject
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * Creates a journal for the given map and checkpoint path.
+	 * 
+	 * The journal needs a checkpoint before changes can be appended.
+	 */
+	AutosaveJournal(Map& map, const QString& checkpoint_path);
+	
+	AutosaveJournal(const AutosaveJournal&) = delete;
+	AutosaveJournal(AutosaveJournal&&) = delete;
+	
+	~AutosaveJournal() override;
+	
+	AutosaveJournal& operator=(const AutosaveJournal&) = delete;
+	AutosaveJournal& operator=(AutosaveJournal&&) = delete;
+	
+	
+	/**
+	 * Returns the path of the checkpoint file.
+	 */
+	const QString& checkpointPath() const { return checkpoint_path; }
+	
+	/**
+	 * Returns the path of the journal file for the given checkpoint path.
+	 */
+	static QString journalPath(const QString& checkpoint_path);
+	
+	
+	/**
+	 * Returns true if the current changes cannot be appended to the journal.
+	 */
+	bool needsCheckpoint() const;
+	
+	/**
+	 * Starts a new, empty journal for a checkpoint which was just written.
+	 * 
+	 * @return false on error
+	 */
+	bool checkpointWritten();
+	
+	/**
+	 * Appends the object changes since the last checkpoint or append.
+	 * 
+	 * Must not be called when needsCheckpoint() returns true.
+	 * 
+	 * @return false on error
+	 */
+	bool append();
+	
+	
+	/**
+	 * Applies the journal for the given checkpoint to the map.
+	 * 
+	 * The map must have been loaded from the checkpoint. A journal which
+	 * does not belong to the checkpoint, i.e. whose checkpoint hash does not
+	 * match the contents of the checkpoint file, is ignored. An incomplete last entry,
+	 * e.g. from a crash while appending, is ignored, too.
+	 * 
+	 * If entries are applied, the undo history is cleared because it does
+	 * no longer match the objects.
+	 * 
+	 * @return false if an entry could not be applied
+	 */
+	static bool replay(Map& map, const QString& checkpoint_path);
+	
+	/**
+	 * Removes the journal for the given checkpoint path, if it exists.
+	 */
+	static bool remove(const QString& checkpoint_path);
+
+
+private:
+	/**
+	 * Records the objects and parts affected by a change.
+	 */
+	void changeApplied(const UndoStep* reverse_step);
+	
+	/**
+	 * Returns true if the checkpoint and the journal file are still
+	 * the ones written by this object.
+	 * 
+	 * This is a cheap check of sizes and modification times. It doesn't
+	 * need to be exact: replay() ignores a journal when the checkpoint
+	 * was replaced.
+	 */
+	bool filesUnchanged() const;
+	
+	
+	Map& map;
+	QString checkpoint_path;
+	
+	/// The objects of each part at the time of the last checkpoint or append
+	std::vector<std::vector<const Object*>> snapshot;
+	
+	/// Objects which were modified since the last checkpoint or append
+	std::unordered_set<const Object*> dirty_objects;
+	
+	/// Parts which were modified since the last checkpoint or append
+	std::set<int> modified_parts;
+	
+	quint64 checkpoint_revision = 0;
+	qint64 checkpoint_size = 0;
+	qint64 checkpoint_modified = 0;
+	qint64 journal_size = 0;
+	bool checkpoint_needed = true;
+	
+};
+
+
+}  // namespace LibreMapper
+
+#endif // LIBREMAPPER_AUTOSAVE_JOURNAL_H
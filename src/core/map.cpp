@@ -473,6 +473,7 @@ void Map::clear()
 	
 	object_selection.clear();
 	first_selected_object = nullptr;
+	pending_selection_renderables.clear();
 	selection_renderables->clear();
 	
 	renderables->clear();
@@ -846,7 +847,8 @@ void Map::drawTemplates(QPainter* painter, const QRectF& bounding_box, int first
 	for (int i = first_template; i <= last_template; ++i)
 	{
 		const Template* temp = getTemplate(i);
-		if (temp->getTemplateState() != Template::Loaded)
+		if (temp->getTemplateState() != Template::Loaded
+		    && temp->getTemplateState() != Template::Unloaded)
 			continue;
 		
 		double scale  = std::max(temp->getTemplateScaleX(), temp->getTemplateScaleY());
@@ -859,6 +861,11 @@ void Map::drawTemplates(QPainter* painter, const QRectF& bounding_box, int first
 		}
 		if (visibility.visible)
 		{
+			// Reloads the template if it was unloaded for the memory budget.
+			temp->recordUsage();
+			if (temp->getTemplateState() != Template::Loaded)
+				continue;
+			
 			Q_ASSERT(visibility.opacity == 1 || painter->paintEngine()->hasFeature(QPaintEngine::ConstantOpacity));
 			painter->save();
 			temp->drawTemplate(painter, bounding_box, scale, on_screen, visibility.opacity);
@@ -984,8 +991,12 @@ void Map::drawSelection(QPainter* painter, bool force_min_size, MapWidget* widge
 	painter->translate(widget->width() / 2.0 + view->panOffset().x(), widget->height() / 2.0 + view->panOffset().y());
 	painter->setWorldTransform(view->worldTransform(), true);
 	
+	auto const viewed_rect = view->calculateViewedRect(widget->viewportToView(widget->rect()));
 	if (!replacement_renderables)
+	{
+		addPendingSelectionRenderables(viewed_rect);
 		replacement_renderables = selection_renderables.data();
+	}
 	
 	RenderConfig::Options options = RenderConfig::Screen | RenderConfig::HelperSymbols;
 	qreal selection_opacity = 1.0;
@@ -996,7 +1007,7 @@ void Map::drawSelection(QPainter* painter, bool force_min_size, MapWidget* widge
 		options |= RenderConfig::Highlighted;
 		selection_opacity = 0.4;
 	}
-	RenderConfig config = { *this, view->calculateViewedRect(widget->viewportToView(widget->rect())), view->calculateFinalZoomFactor(), {}, options, selection_opacity };
+	RenderConfig config = { *this, viewed_rect, view->calculateFinalZoomFactor(), {}, options, selection_opacity };
 	replacement_renderables->draw(painter, config);
 	
 	painter->restore();
@@ -1012,7 +1023,7 @@ void Map::addObjectToSelection(Object* object, bool emit_selection_changed)
 		return;
 
 	object_selection.insert(object);
-	addSelectionRenderables(object);
+	pending_selection_renderables.insert(object);
 	if (!first_selected_object)
 		first_selected_object = object;
 	if (emit_selection_changed)
@@ -1033,23 +1044,15 @@ void Map::removeObjectFromSelection(Object* object, bool emit_selection_changed)
 
 bool Map::removeSymbolFromSelection(const Symbol* symbol, bool emit_selection_changed)
 {
-	bool removed_at_least_one_object = false;
-	auto it_end = object_selection.end();
-	for (auto it = object_selection.begin(); it != it_end; )
-	{
-		if ((*it)->getSymbol() != symbol)
-		{
-			++it;
-			continue;
-		}
-		
-		removed_at_least_one_object = true;
-		removeSelectionRenderables(*it);
-		Object* removed_object = *it;
-		it = object_selection.erase(it);
-		if (first_selected_object == removed_object)
-			first_selected_object = object_selection.empty() ? nullptr : *object_selection.begin();
-	}
+	auto const removed = object_selection.eraseIf([this, symbol](const Object* object) {
+		if (object->getSymbol() != symbol)
+			return false;
+		removeSelectionRenderables(object);
+		return true;
+	});
+	bool const removed_at_least_one_object = removed > 0;
+	if (first_selected_object && first_selected_object->getSymbol() == symbol)
+		first_selected_object = object_selection.empty() ? nullptr : *object_selection.begin();
 	if (emit_selection_changed && removed_at_least_one_object)
 		emit objectSelectionChanged();
 	return removed_at_least_one_object;
@@ -1057,7 +1060,7 @@ bool Map::removeSymbolFromSelection(const Symbol* symbol, bool emit_selection_ch
 
 bool Map::isObjectSelected(const Object* object) const
 {
-	return object_selection.find(const_cast<Object*>(object)) != object_selection.end();
+	return object_selection.contains(object);
 }
 
 bool Map::toggleObjectSelection(Object* object, bool emit_selection_changed)
@@ -1079,6 +1082,7 @@ void Map::clearObjectSelection(bool emit_selection_changed)
 	selection_renderables->clear();
 	object_selection.clear();
 	first_selected_object = nullptr;
+	pending_selection_renderables.clear();
 	
 	if (emit_selection_changed)
 		emit objectSelectionChanged();
@@ -1303,6 +1307,7 @@ int Map::findColorPrio(const MapColor* color) const
 void Map::setColorsDirty()
 {
 	colors_dirty = true;
+	++non_object_revision;
 	setHasUnsavedChanges(true);
 }
 
@@ -1431,6 +1436,7 @@ void Map::setSymbolSetId(const QString& id)
 {
 	symbol_set_id = id;
 	symbols_dirty = true;
+	++non_object_revision;
 }
 
 
@@ -1498,6 +1504,7 @@ QHash<const Symbol*, Symbol*> Map::importSymbols(
 
 void Map::addSelectionRenderables(const Object* object)
 {
+	pending_selection_renderables.erase(object);
 	object->update();
 	selection_renderables->insertRenderablesOfObject(object);
 }
@@ -1510,7 +1517,24 @@ void Map::updateSelectionRenderables(const Object* object)
 
 void Map::removeSelectionRenderables(const Object* object)
 {
-	selection_renderables->removeRenderablesOfObject(object, false);
+	// Pending objects do not have renderables yet.
+	if (!pending_selection_renderables.erase(object))
+		selection_renderables->removeRenderablesOfObject(object, false);
+}
+
+void Map::addPendingSelectionRenderables(const QRectF& area)
+{
+	// Take the objects out first, for robustness against reentrance.
+	std::vector<const Object*> visible;
+	pending_selection_renderables.eraseIf([&visible, &area](const Object* object) {
+		object->update();
+		if (!object->getExtent().intersects(area))
+			return false;
+		visible.push_back(object);
+		return true;
+	});
+	for (const auto* object : visible)
+		selection_renderables->insertRenderablesOfObject(object);
 }
 
 void Map::initStatic()
@@ -1677,6 +1701,7 @@ void Map::setSymbolsDirty()
 		QTimer::singleShot(0, this, &Map::updateSymbolIconZoom);
 	}
 	symbols_dirty = true;
+	++non_object_revision;
 	setHasUnsavedChanges(true);
 }
 
@@ -1962,6 +1987,7 @@ int Map::findTemplateIndex(const Template* temp) const
 void Map::setTemplatesDirty()
 {
 	templates_dirty = true;
+	++non_object_revision;
 	setHasUnsavedChanges(true);
 }
 
@@ -2517,6 +2543,7 @@ void Map::setHasUnsavedChanges(bool has_unsaved_changes)
 void Map::setOtherDirty()
 {
 	other_dirty = true;
+	++non_object_revision;
 	setHasUnsavedChanges(true);
 }
 
@@ -33,6 +33,7 @@
 #include "core/map_coord.h"
 #include "core/map_grid.h"
 #include "core/map_part.h"
+#include "core/objects/object_selection.h"
 // IWYU pragma: no_include "templates/template.h"
 
 class QIODevice;
@@ -82,8 +83,8 @@ friend class MapRenderables;
 friend class XMLFileImporter;
 friend class XMLFileExporter;
 public:
-	/** A set of selected objects represented by a std::set of object pointers. */
-	typedef std::set<Object*> ObjectSelection;
+	/** A set of selected objects represented by a flat set of object pointers. */
+	using ObjectSelection = LibreMapper::ObjectSelection;
 	
 	/**
 	 * Different strategies for importing elements from another map.
@@ -1375,6 +1376,15 @@ public:
 	 */
 	void setOtherDirty();
 	
+	/**
+	 * Returns a number which changes whenever the colors, symbols, templates,
+	 * or anything else than the objects are marked as dirty.
+	 * 
+	 * In contrast to the dirty flags, this number is not reset by saving.
+	 * Changes to objects are tracked via the undo steps instead.
+	 */
+	quint64 nonObjectRevision() const;
+	
 	
 	// Static
 	
@@ -1605,6 +1615,19 @@ private:
 	void updateSelectionRenderables(const Object* object);
 	void removeSelectionRenderables(const Object* object);
 	
+	/**
+	 * Creates the selection renderables for pending selected objects which
+	 * intersect the given area.
+	 * 
+	 * The creation is deferred so that selecting many objects at once does
+	 * not need to wait for the renderables, and so that objects which are
+	 * deselected again, or never scrolled into view, never get renderables.
+	 * Objects outside the area remain pending.
+	 * 
+	 * This is called by drawSelection() with the viewed rect.
+	 */
+	void addPendingSelectionRenderables(const QRectF& area);
+	
 	static void initStatic();
 	
 	QExplicitlySharedDataPointer<MapColorSet> color_set;
@@ -1618,6 +1641,7 @@ private:
 	PartVector parts;
 	ObjectSelection object_selection;
 	Object* first_selected_object = nullptr;
+	ObjectSelection pending_selection_renderables;  ///< Selected objects without selection renderables
 	QScopedPointer<UndoManager> undo_manager;
 	std::size_t current_part_index = 0;
 	WidgetVector widgets;
@@ -1641,6 +1665,7 @@ private:
 	bool templates_dirty;			//    ... for the templates?
 	bool objects_dirty;				//    ... for the objects?
 	bool other_dirty;				//    ... for any other settings?
+	quint64 non_object_revision = 0;	// see nonObjectRevision()
 	bool unsaved_changes;			// are there unsaved changes for any component?
 	bool unsaved_changes_signaled = false; // state of unsaved_changes before signals were blocked
 	
@@ -1883,6 +1908,12 @@ bool Map::isOtherDirty() const
 	return other_dirty;
 }
 
+inline
+quint64 Map::nonObjectRevision() const
+{
+	return non_object_revision;
+}
+
 inline
 const MapColor* Map::getCoveringRed()
 {
@@ -8,12 +8,14 @@
 
 #include "map_coord.h"
 
+#include <cstddef>
 #include <cstdlib>
 #include <iterator>
 #include <limits>
 #include <stdexcept>
 #include <type_traits>
 
+#include <QtAlgorithms>
 #include <QChar>
 #include <QLatin1Char>
 #include <QLatin1String>
@@ -22,6 +24,10 @@
 
 #include "util/xml_stream_util.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 
 namespace LibreMapper {
 
@@ -172,6 +178,38 @@ void ensureBoundsForQint32(qint64 x64, qint64 y64)
 	}
 }
 
+inline
+bool isCoordWhitespace(char16_t c)
+{
+	return c == u' ' || c == u'\n' || c == u'\r';
+}
+
+/**
+ * Returns the number of decimal digits at the beginning of [first, last).
+ */
+inline
+std::ptrdiff_t digitCount(const char16_t* first, const char16_t* last)
+{
+	auto* p = first;
+#ifdef __SSE2__
+	auto const below_zero = _mm_set1_epi16(u'0' - 1);
+	auto const above_nine = _mm_set1_epi16(u'9' + 1);
+	for (; last - p >= 8; p += 8)
+	{
+		// Characters above 0x7fff are negative here, and so they are no digits.
+		auto const chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		auto const digits = _mm_and_si128(_mm_cmpgt_epi16(chars, below_zero),
+		                                  _mm_cmplt_epi16(chars, above_nine));
+		auto const mask = unsigned(_mm_movemask_epi8(digits));
+		if (mask != 0xffff)
+			return (p - first) + qCountTrailingZeroBits(~mask & 0xffffu) / 2;  // two mask bits per character
+	}
+#endif
+	while (p != last && *p >= u'0' && *p <= u'9')
+		++p;
+	return p - first;
+}
+
 }  // namespace
 
 
@@ -488,5 +526,77 @@ MapCoord::MapCoord(QStringView& text)
 	text = text.mid(i, len-i);
 }
 
+// static
+void MapCoord::appendFromString(QStringView text, std::vector<MapCoord>& coords)
+{
+	auto const* p = reinterpret_cast<const char16_t*>(text.utf16());
+	auto const* const last = p + text.size();
+	
+	auto const skip_whitespace = [&p, last]() {
+		while (p != last && isCoordWhitespace(*p))
+			++p;
+	};
+	auto const parse_digits = [&p, last]() -> qint64 {
+		auto const count = digitCount(p, last);
+		if (Q_UNLIKELY(count == 0))
+			throw std::invalid_argument("Invalid data");
+		if (Q_UNLIKELY(count > 18))
+			throw std::range_error(QT_TRANSLATE_NOOP("LibreMapper::MapCoord", "Coordinates are out-of-bounds."));
+		auto value = qint64(0);
+		for (auto const* end = p + count; p != end; ++p)
+			value = 10*value + (*p - u'0');
+		return value;
+	};
+	auto const parse_number = [&p, last, &parse_digits]() -> qint64 {
+		if (p != last && *p == u'-')
+		{
+			++p;
+			return -parse_digits();
+		}
+		return parse_digits();
+	};
+	
+	skip_whitespace();
+	while (p != last)
+	{
+		auto x64 = parse_number();
+		if (Q_UNLIKELY(p == last || !isCoordWhitespace(*p)))
+			throw std::invalid_argument("Premature end of data");
+		skip_whitespace();
+		auto y64 = parse_number();
+		
+		auto flags = qint64(0);
+		if (p != last && isCoordWhitespace(*p))
+		{
+			skip_whitespace();
+			// there are no negative flags
+			flags = parse_digits();
+		}
+		
+		if (Q_UNLIKELY(p == last || *p != u';'))
+			throw std::invalid_argument("Invalid data");
+		++p;
+		skip_whitespace();
+		
+		handleBoundsOffset(x64, y64);
+		ensureBoundsForQint32(x64, y64);
+		coords.push_back(MapCoord{ static_cast<qint32>(x64), static_cast<qint32>(y64), Flags(int(flags)) });
+	}
+}
+
+// static
+void MapCoord::appendFromNative(const qint32* x, const qint32* y, const quint8* flags, std::size_t count, std::vector<MapCoord>& coords)
+{
+	coords.reserve(coords.size() + count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		qint64 x64 = x[i];
+		qint64 y64 = y[i];
+		handleBoundsOffset(x64, y64);
+		ensureBoundsForQint32(x64, y64);
+		coords.push_back(MapCoord{ static_cast<qint32>(x64), static_cast<qint32>(y64), Flags(int(flags[i])) });
+	}
+}
+
 
 }  // namespace LibreMapper
@@ -12,6 +12,7 @@
 
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <vector>
 
 #include <QtGlobal>
@@ -427,6 +428,24 @@ public:
 	 */
 	MapCoord(QStringView& text);
 	
+	/**
+	 * Parses all coordinates in text and appends them to coords.
+	 * 
+	 * This is the bulk counterpiece to toString(), parsing the text in a
+	 * single pass. Whitespace may separate the coordinates. It will throw a
+	 * std::invalid_argument if the text does not contain valid data.
+	 * 
+	 * The boundsOffset() is handled like in MapCoord(QStringView&).
+	 */
+	static void appendFromString(QStringView text, std::vector<MapCoord>& coords);
+	
+	/**
+	 * Appends count coordinates from native coordinate and flag columns to coords.
+	 * 
+	 * The boundsOffset() is handled like in MapCoord(QStringView&).
+	 */
+	static void appendFromNative(const qint32* x, const qint32* y, const quint8* flags, std::size_t count, std::vector<MapCoord>& coords);
+	
 	
 	/** Saves the MapCoord in xml format to the stream. */
 	void save(QXmlStreamWriter& xml) const;
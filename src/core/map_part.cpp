@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <utility>
 
 #include <QtGlobal>
 #include <QLatin1String>
@@ -101,7 +102,10 @@ MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol
 			while (xml.readNextStartElement())
 			{
 				if (xml.name() == literal::object)
+				{
 					part->objects.push_back(Object::load(xml, &map, symbol_dict));
+					part->objects.back()->map_part_index = part->objects.size() - 1;
+				}
 				else
 					xml.skipCurrentElement(); // unknown
 			}
@@ -114,19 +118,33 @@ MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol
 }
 
 
+std::size_t MapPart::indexOf(const Object* object) const
+{
+	// Objects from other parts, or released ones, fail the comparison.
+	auto const index = object->map_part_index;
+	if (index < objects.size() && objects[index] == object)
+		return index;
+	return objects.size();
+}
+
+void MapPart::updateIndices(std::size_t pos)
+{
+	for (auto i = pos; i < objects.size(); ++i)
+		objects[i]->map_part_index = i;
+}
+
+
 bool MapPart::contains(const Object* const object) const
 {
-	return existsObject([object](auto const* o) { return object == o; });
+	return indexOf(object) < objects.size();
 }
 
 int MapPart::findObjectIndex(const Object* object) const
 {
-	int size = objects.size();
-	for (int i = size - 1; i >= 0; --i)
-	{
-		if (objects[i] == object)
-			return i;
-	}
+	auto const index = indexOf(object);
+	if (index < objects.size())
+		return int(index);
+	
 	Q_ASSERT(false);
 	return -1;
 }
@@ -138,6 +156,7 @@ void MapPart::setObject(Object* object, int pos, bool delete_old)
 		delete objects[pos];
 	
 	objects[pos] = object;
+	object->map_part_index = std::size_t(pos);
 	object->setMap(map);
 	object->update();
 	map->setObjectsDirty(); // TODO: remove from here, dirty state handling should be separate
@@ -151,6 +170,7 @@ void MapPart::addObject(Object* object)
 void MapPart::addObject(Object* object, int pos)
 {
 	objects.insert(objects.begin() + pos, object);
+	updateIndices(std::size_t(pos));
 	object->setMap(map);
 	object->update();
 	
@@ -176,6 +196,7 @@ Object* MapPart::releaseObject(int pos)
 	map->removeRenderablesOfObject(objects[pos], true);
 	auto object_to_return = objects[pos];
 	objects.erase(objects.begin() + pos);
+	updateIndices(std::size_t(pos));
 	
 	if (objects.empty() && map->getNumObjects() == 0)
 		map->updateAllMapWidgets();
@@ -185,15 +206,96 @@ Object* MapPart::releaseObject(int pos)
 
 Object* MapPart::releaseObject(Object* object)
 {
-	int size = objects.size();
-	for (int i = size - 1; i >= 0; --i)
+	auto const index = indexOf(object);
+	if (index < objects.size())
+		return releaseObject(int(index));
+	return nullptr;
+}
+
+void MapPart::addObjects(std::vector<std::pair<int, Object*>> objects_with_positions)
+{
+	if (objects_with_positions.empty())
+		return;
+	
+	std::stable_sort(begin(objects_with_positions), end(objects_with_positions), [](auto const& a, auto const& b) {
+		return a.first < b.first;
+	});
+	Q_ASSERT(std::size_t(objects_with_positions.back().first) < objects.size() + objects_with_positions.size());
+	
+	ObjectList merged;
+	merged.reserve(objects.size() + objects_with_positions.size());
+	auto existing = begin(objects);
+	for (auto const& item : objects_with_positions)
 	{
-		if (objects[i] == object)
+		auto const missing = std::size_t(item.first) - std::min(merged.size(), std::size_t(item.first));
+		auto const count = std::min(missing, std::size_t(std::distance(existing, end(objects))));
+		merged.insert(end(merged), existing, existing + count);
+		existing += count;
+		merged.push_back(item.second);
+	}
+	merged.insert(end(merged), existing, end(objects));
+	objects.swap(merged);
+	updateIndices(std::size_t(objects_with_positions.front().first));
+	
+	for (auto const& item : objects_with_positions)
+	{
+		item.second->setMap(map);
+		item.second->update();
+	}
+	
+	if (objects.size() == objects_with_positions.size() && map->getNumObjects() == getNumObjects())
+		map->updateAllMapWidgets();
+}
+
+std::vector<Object*> MapPart::releaseObjects(std::vector<int> positions)
+{
+	std::sort(begin(positions), end(positions));
+	positions.erase(std::unique(begin(positions), end(positions)), end(positions));
+	
+	std::vector<Object*> released;
+	if (positions.empty())
+		return released;
+	
+	released.reserve(positions.size());
+	QRectF dirty_rect;
+	for (auto pos : positions)
+	{
+		auto* object = objects[std::size_t(pos)];
+		auto const extent = object->getExtent();
+		map->removeRenderablesOfObject(object, !extent.isValid());
+		rectIncludeSafe(dirty_rect, extent);
+		released.push_back(object);
+	}
+	if (dirty_rect.isValid())
+		map->setObjectAreaDirty(dirty_rect);
+	
+	// Compact the remaining objects in a single pass, updating their indices.
+	auto next_position = begin(positions);
+	auto index = std::size_t(*next_position);
+	auto out = begin(objects) + *next_position;
+	for (auto in = out; in != end(objects); ++in, ++index)
+	{
+		if (next_position != end(positions) && std::size_t(*next_position) == index)
 		{
-			return releaseObject(i);
+			++next_position;
+			continue;
 		}
+		
+		(*in)->map_part_index = std::size_t(out - begin(objects));
+		*out++ = *in;
 	}
-	return nullptr;
+	objects.erase(out, end(objects));
+	
+	if (objects.empty() && map->getNumObjects() == 0)
+		map->updateAllMapWidgets();
+	
+	return released;
+}
+
+void MapPart::deleteObjects(std::vector<int> positions)
+{
+	for (auto* object : releaseObjects(std::move(positions)))
+		delete object;
 }
 
 std::unique_ptr<UndoStep> MapPart::importPart(const MapPart* other, const QHash<const Symbol*, Symbol*>& symbol_map, const QTransform& transform, bool select_new_objects)
@@ -215,6 +317,7 @@ std::unique_ptr<UndoStep> MapPart::importPart(const MapPart* other, const QHash<
 		new_object->transform(transform);
 		
 		objects.push_back(new_object);
+		new_object->map_part_index = objects.size() - 1;
 		new_object->setMap(map);
 		new_object->update();
 		
@@ -118,8 +118,7 @@ public:
 	/**
 	 * Returns the index of the object.
 	 * 
-	 * Loops over all objects in the part and looks for the given pointer.
-	 * The object must be contained in this part,
+	 * This is a constant-time lookup. The object must be contained in this part,
 	 * otherwise an assert is triggered (in debug builds),
 	 * or -1 is returned (release builds).
 	 */
@@ -169,6 +168,29 @@ public:
 	  * structures. Object deletion is caller's responsibility.
 	  */
 	Object* releaseObject(Object* object);
+	
+	/**
+	 * Adds the objects at the given indices.
+	 * 
+	 * The indices refer to the positions after insertion, i.e. the result
+	 * is the same as adding the objects one by one in ascending order of
+	 * the indices. All objects are inserted in a single pass.
+	 */
+	void addObjects(std::vector<std::pair<int, Object*>> objects_with_positions);
+	
+	/**
+	  * Relinquish ownership of the objects at the given indices.
+	  *
+	  * All objects are removed in a single pass. The released objects are
+	  * returned in ascending order of their former indices. Object deletion
+	  * is caller's responsibility.
+	  */
+	std::vector<Object*> releaseObjects(std::vector<int> positions);
+	
+	/**
+	 * Deletes the objects at the given indices.
+	 */
+	void deleteObjects(std::vector<int> positions);
 
 	
 	/**
@@ -253,6 +275,19 @@ public:
 	
 private:
 	typedef std::vector<Object*> ObjectList;
+	
+	/**
+	 * Returns the index of the object, or the number of objects if not found.
+	 */
+	std::size_t indexOf(const Object* object) const;
+	
+	/**
+	 * Updates the stored indices of the objects starting from pos.
+	 * 
+	 * This is called after every insertion or removal which moves objects,
+	 * so that the stored indices are always exact.
+	 */
+	void updateIndices(std::size_t pos);
 
 	QString name;
 	ObjectList objects;  ///< @todo This could be a spatial representation optimized for quick access
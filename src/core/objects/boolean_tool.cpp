@@ -13,6 +13,8 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <exception>
+#include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
@@ -21,8 +23,6 @@
 #include <QtGlobal>
 #include <QDebug>
 #include <QFlags>
-#include <QHash>
-#include <QHashFunctions>
 #include <QScopedPointer>
 
 #include <clipper2/clipper.h>
@@ -36,42 +36,113 @@
 #include "core/symbols/symbol.h"
 #include "undo/object_undo.h"
 #include "undo/undo.h"
+#include "util/concurrency.h"
 #include "util/util.h"
 
 
-//### Local helper functions
+namespace LibreMapper {
+
+namespace {
+
+using PathCoordInfo = std::pair<const PathPart*, const PathCoord*>;
+
+}  // namespace
 
-/*
- * NB: qHash must be in the same namespace as the QHash key.
- * This is a C++ language issue, not a Qt issue.
- * Cf. https://bugreports.qt-project.org/browse/QTBUG-34912
- */
-namespace Clipper2Lib {
 
 /**
- * Implements qHash for Clipper2Lib::Point64.
+ * Maps polygon point locations to the path coords they were created from.
+ * 
+ * The entries are collected in a plain array which is sorted once by
+ * finalize(), before the first lookup. Lookups are binary searches.
+ * Among the entries for the same location, the most recently inserted
+ * entry comes first.
  * 
- * This is needed to use Clipper2Lib::Point64 as QHash key.
+ * clear() keeps the allocated memory, so that an instance can be reused
+ * for multiple operations.
  */
-uint qHash(const Point64& point, uint seed)
+class BooleanTool::PolyMap
 {
-	quint64 tmp = (quint64(point.x) & 0xffffffff) | (quint64(point.y) << 32);
-	return ::qHash(tmp, seed); // must use :: namespace to prevent endless recursion
-}
-
-
-}  // namespace Clipper2Lib
-
-
+public:
+	struct Entry
+	{
+		Clipper2Lib::Point64 point;
+		PathCoordInfo info;
+	};
+	
+	using const_iterator = std::vector<Entry>::const_iterator;
+	
+	/**
+	 * The entries for a particular location.
+	 */
+	struct Range
+	{
+		const_iterator first;
+		const_iterator last;
+		
+		const_iterator begin() const { return first; }
+		const_iterator end() const { return last; }
+		bool empty() const { return first == last; }
+	};
+	
+	void clear()
+	{
+		entries.clear();
+	}
+	
+	void insert(const Clipper2Lib::Point64& point, const PathCoordInfo& info)
+	{
+		entries.push_back({point, info});
+	}
+	
+	/**
+	 * Sorts the entries. Must be called after insertion, before lookup.
+	 */
+	void finalize()
+	{
+		std::reverse(begin(entries), end(entries));
+		std::stable_sort(begin(entries), end(entries), [](const Entry& lhs, const Entry& rhs) {
+			return less(lhs.point, rhs.point);
+		});
+	}
+	
+	/**
+	 * Returns the entries for the given location.
+	 */
+	Range values(const Clipper2Lib::Point64& point) const
+	{
+		auto const first = std::lower_bound(begin(entries), end(entries), point, [](const Entry& entry, const Clipper2Lib::Point64& point) {
+			return less(entry.point, point);
+		});
+		auto last = first;
+		while (last != end(entries) && last->point == point)
+			++last;
+		return { first, last };
+	}
+	
+	/**
+	 * Returns the most recently inserted info for the given location,
+	 * or a pair of nullptr if there is no entry for this location.
+	 */
+	PathCoordInfo value(const Clipper2Lib::Point64& point) const
+	{
+		auto const range = values(point);
+		return range.empty() ? PathCoordInfo{ nullptr, nullptr } : range.first->info;
+	}
+	
+private:
+	static bool less(const Clipper2Lib::Point64& lhs, const Clipper2Lib::Point64& rhs)
+	{
+		return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+	}
+	
+	std::vector<Entry> entries;
+};
 
-namespace LibreMapper {
 
 namespace {
 
 using PathObjects = BooleanTool::PathObjects;
-
-using PathCoordInfo = std::pair<const PathPart*, const PathCoord*>;
-using PolyMap = QMultiHash<Clipper2Lib::Point64, PathCoordInfo>;
+using PolyMap = BooleanTool::PolyMap;
 
 /**
  * Converts a Clipper2Lib::PolyTree64 to PathObjects.
@@ -280,12 +351,21 @@ bool BooleanTool::executePerSymbol()
 			backlog.push_back(object->asPath());
 	}
 	
-	auto undo_step = std::make_unique<CombinedUndoStep>(map);
+	// The operation for one symbol, and its result
+	struct SymbolGroup
+	{
+		PathObject* subject;
+		PathObjects in_objects;
+		PathObjects out_objects;
+		bool success = false;
+		std::exception_ptr error;
+	};
+	std::vector<SymbolGroup> groups;
+	
 	PathObjects new_backlog;
 	new_backlog.reserve(backlog.size()/2);
 	PathObjects in_objects;
 	in_objects.reserve(backlog.size()/2);
-	PathObjects out_objects;
 	while (!backlog.empty())
 	{
 		PathObject* const primary_object = backlog.front();
@@ -314,9 +394,49 @@ bool BooleanTool::executePerSymbol()
 		if (in_objects.size() == 1)
 			continue;
 		
-		// Perform the core operation
-		out_objects.clear();
-		executeForObjects(primary_object, in_objects, out_objects, *undo_step);
+		// Object::update() may change the map, so it must not run concurrently.
+		primary_object->update();
+		for (PathObject* object : in_objects)
+			object->update();
+		
+		groups.push_back({primary_object, in_objects, {}});
+	}
+	
+	// Perform the core operation concurrently. The groups are disjoint,
+	// and executeForObjects() does not change the map.
+	std::vector<PolyMap> polymaps(concurrentWorkers(groups.size(), 1));  // reused for all groups of a thread
+	processConcurrently(groups.size(), 1, [&](std::size_t first, std::size_t last, std::size_t worker) {
+		for (auto i = first; i < last; ++i)
+		{
+			auto& group = groups[i];
+			try
+			{
+				group.success = executeForObjects(group.subject, group.in_objects, group.out_objects, polymaps[worker]);
+			}
+			catch (...)
+			{
+				group.error = std::current_exception();
+			}
+		}
+	});
+	
+	auto const failed = std::find_if(begin(groups), end(groups), [](const auto& group) { return bool(group.error); });
+	if (failed != end(groups))
+	{
+		for (auto& group : groups)
+		{
+			for (PathObject* object : group.out_objects)
+				delete object;
+		}
+		std::rethrow_exception(failed->error);
+	}
+	
+	// Change the map in the original order of the symbols.
+	auto undo_step = std::make_unique<CombinedUndoStep>(map);
+	for (auto& group : groups)
+	{
+		if (group.success)
+			replaceObjects(group.subject, group.in_objects, group.out_objects, *undo_step);
 	}
 	
 	bool const have_changes = undo_step->getNumSubSteps() > 0;
@@ -338,6 +458,12 @@ bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects
 		return false; // in release build
 	}
 	
+	replaceObjects(subject, in_objects, out_objects, undo_step);
+	return true;
+}
+
+void BooleanTool::replaceObjects(const PathObject* subject, const PathObjects& in_objects, const PathObjects& out_objects, CombinedUndoStep& undo_step)
+{
 	// Add original objects to undo step, and remove them from map.
 	auto add_step = std::make_unique<AddObjectsUndoStep>(map);
 	for (PathObject* object : in_objects)
@@ -374,15 +500,20 @@ bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects
 	
 	undo_step.push(add_step.release());
 	undo_step.push(delete_step.release());
-	return true;
 }
 
 bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects& in_objects, PathObjects& out_objects) const
+{
+	PolyMap polymap;
+	return executeForObjects(subject, in_objects, out_objects, polymap);
+}
+
+bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects& in_objects, PathObjects& out_objects, PolyMap& polymap) const
 {
 	// Convert the objects to Clipper polygons and
-	// create a hash map, mapping point positions to the PathCoords.
+	// create a lookup table, mapping point positions to the PathCoords.
 	// These paths are to be regarded as closed.
-	PolyMap polymap;
+	polymap.clear();
 	
 	Clipper2Lib::Paths64 subject_polygons;
 	pathObjectToPolygons(subject, subject_polygons, polymap);
@@ -395,6 +526,7 @@ bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects
 			pathObjectToPolygons(object, clip_polygons, polymap);
 		}
 	}
+	polymap.finalize();
 	
 	// Do the operation.
 	Clipper2Lib::Clipper64 clipper;
@@ -615,13 +747,13 @@ void polygonToPathPart(const Clipper2Lib::Path64& polygon, const PolyMap& polyma
 	// (because we cannot start in the middle of a curve)
 	for (; part_start_index < num_points; ++part_start_index)
 	{
-		auto current_point = polygon.at(part_start_index);
-		if (!polymap.contains(current_point))
+		auto const info = polymap.value(polygon.at(part_start_index));
+		if (!info.first)
 			break;
 		
-		if (polymap.value(current_point).second->param == 0.0)
+		if (info.second->param == 0.0)
 		{
-			cur_info = polymap.value(current_point);
+			cur_info = info;
 			break;
 		}
 	}
@@ -654,10 +786,7 @@ void polygonToPathPart(const Clipper2Lib::Path64& polygon, const PolyMap& polyma
 		if (i >= num_points)
 			i = 0;
 		
-		PathCoordInfo new_info{ nullptr, nullptr };
-		auto new_point = polygon.at(i);
-		if (polymap.contains(new_point))
-			new_info = polymap.value(new_point);
+		auto new_info = polymap.value(polygon.at(i));
 		
 		if (cur_info.first && cur_info.first == new_info.first)
 		{
@@ -797,19 +926,18 @@ void rebuildSegment(
 	bool found = false;
 	PathCoordInfo second_info{ nullptr, nullptr };
 	PathCoordInfo second_last_info{ nullptr, nullptr };
-	for (auto second_it = polymap.find(second_point); second_it != polymap.end(); ++second_it)
+	auto const second_last_entries = polymap.values(second_last_point);
+	for (const auto& second_entry : polymap.values(second_point))
 	{
-		for (auto second_last_it = polymap.find(second_last_point);
-		     second_last_it != polymap.end() && second_last_it.key() == second_last_point;
-		     ++second_last_it)
+		for (const auto& second_last_entry : second_last_entries)
 		{
-			if (second_it->first == second_last_it->first &&
-			    second_it->second->index == second_last_it->second->index)
+			if (second_entry.info.first == second_last_entry.info.first &&
+			    second_entry.info.second->index == second_last_entry.info.second->index)
 			{
 				// Same part
 				found = true;
-				second_info = *second_it;
-				second_last_info = *second_last_it;
+				second_info = second_entry.info;
+				second_last_info = second_last_entry.info;
 				break;
 			}
 		}
@@ -829,26 +957,22 @@ void rebuildSegment(
 	
 	// Try to find the outer coordinates in the same part
 	PathCoordInfo start_info{ nullptr, nullptr };
-	for (auto start_it = polymap.find(start_point);
-	     start_it != polymap.end() && start_it.key() == start_point;
-	     ++start_it)
+	for (const auto& start_entry : polymap.values(start_point))
 	{
-		if (start_it->first == original_path)
+		if (start_entry.info.first == original_path)
 		{
-			start_info = *start_it;
+			start_info = start_entry.info;
 			break;
 		}
 	}
 	Q_ASSERT(!start_info.first || start_info.first == second_info.first);
 	
 	PathCoordInfo end_info{ nullptr, nullptr };
-	for (auto end_it = polymap.find(end_point);
-	     end_it != polymap.end() && end_it.key() == end_point;
-	     ++end_it)
+	for (const auto& end_entry : polymap.values(end_point))
 	{
-		if (end_it->first == original_path)
+		if (end_entry.info.first == original_path)
 		{
-			end_info = *end_it;
+			end_info = end_entry.info;
 			break;
 		}
 	}
@@ -1162,9 +1286,9 @@ void rebuildCoordinate(
         bool start_new_part)
 {
 	auto coord = MapCoord::fromNative64(polygon.at(index).x, polygon.at(index).y);
-	if (polymap.contains(polygon.at(index)))
+	auto const info = polymap.value(polygon.at(index));
+	if (info.first)
 	{
-		PathCoordInfo info = polymap.value(polygon.at(index));
 		const auto original = info.first->path->getCoordinate(info.second->index);
 		
 		if (original.isDashPoint())
@@ -40,6 +40,11 @@ public:
 	 */
 	typedef std::vector< PathObject* > PathObjects;
 	
+	/**
+	 * A lookup table from polygon points to the original path coords.
+	 */
+	class PolyMap;
+	
 	/**
 	 * Types of boolean operation.
 	 */
@@ -79,6 +84,9 @@ public:
 	 * operation failed for remain unchanged. The operation continues for other
 	 * groups of objects.
 	 * 
+	 * The groups are processed concurrently. The map is changed afterwards,
+	 * in the order of the groups.
+	 * 
 	 * @return True if the map was changed, false otherwise.
 	 */
 	bool executePerSymbol();
@@ -127,6 +135,34 @@ protected:
 	        PathObjects& out_objects,
 	        CombinedUndoStep& undo_step );
 	
+	/**
+	 * Executes the operation on particular objects, using the given lookup table.
+	 * 
+	 * The lookup table is cleared and refilled. Reusing it for multiple
+	 * operations saves allocations.
+	 */
+	bool executeForObjects(
+	        const PathObject* subject,
+	        const PathObjects& in_objects,
+	        PathObjects& out_objects,
+	        PolyMap& polymap ) const;
+	
+	/**
+	 * Replaces the input objects with the result of an operation, and provides undo steps.
+	 * 
+	 * This function changes the collection of objects in the map and the selection.
+	 * 
+	 * @param subject               The primary affected object.
+	 * @param in_objects            All objects which were operated on.
+	 * @param out_objects           The resulting objects, to be owned by the map.
+	 * @param undo_step             A combined undo step which will be filled with sub steps.
+	 */
+	void replaceObjects(
+	        const PathObject* subject,
+	        const PathObjects& in_objects,
+	        const PathObjects& out_objects,
+	        CombinedUndoStep& undo_step );
+	
 	Operation const op;
 	Map* const map;
 };
@@ -12,11 +12,14 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <Qt>
 #include <QtNumeric>
@@ -117,7 +120,7 @@ void Object::copyFrom(const Object& other)
 	rotation = other.rotation;
 	// map unchanged!
 	object_tags = other.object_tags;
-	output_dirty = true;
+	setOutputDirty();
 	extent = other.extent;
 }
 
@@ -2216,6 +2219,122 @@ PathPart::size_type PathObject::convertRangeToCurves(const PathPart& part, PathP
 	return end_index;
 }
 
+namespace {
+
+/**
+ * Returns the squared distance of the point from the line segment.
+ */
+double distanceSquaredToSegment(const MapCoordF& point, const MapCoordF& start, const MapCoordF& end)
+{
+	auto const direction = end - start;
+	auto const length_squared = direction.lengthSquared();
+	if (qIsNull(length_squared))
+		return point.distanceSquaredTo(start);
+	
+	auto const factor = qBound(0.0, MapCoordF::dotProduct(point - start, direction) / length_squared, 1.0);
+	return point.distanceSquaredTo(start + direction * factor);
+}
+
+/**
+ * Simplifies a path part which has only straight segments.
+ * 
+ * The cost of deleting a node is the maximum distance of the original
+ * nodes between its current neighbours from the segment which replaces
+ * them. For straight segments, this is the same value which sampling the
+ * original path finds, cf. PathObject::calcMaximumDistanceTo().
+ * 
+ * The node with the lowest cost is deleted until this cost exceeds the
+ * threshold. The costs are kept in a binary heap, and after each deletion,
+ * only the costs of the two neighbours are recalculated.
+ * 
+ * @param points     The nodes of the part, without the closing point.
+ * @param closed     True if the part is closed.
+ * @param threshold  The maximum acceptable cost.
+ * @return For each node, true if the node is to be kept.
+ */
+std::vector<bool> simplifyPolygonalPart(const std::vector<MapCoordF>& points, bool closed, double threshold)
+{
+	auto const num_points = points.size();
+	std::vector<bool> keep(num_points, true);
+	
+	// Don't simplify parts which would get deleted.
+	auto const minimum_part_size = std::size_t(closed ? 4 : 3);
+	if (num_points < minimum_part_size)
+		return keep;
+	
+	// A doubly-linked list of the remaining nodes
+	std::vector<std::size_t> prev(num_points);
+	std::vector<std::size_t> next(num_points);
+	for (std::size_t i = 0; i < num_points; ++i)
+	{
+		prev[i] = (i > 0) ? i - 1 : num_points - 1;
+		next[i] = (i + 1 < num_points) ? i + 1 : 0;
+	}
+	
+	auto const is_deletable = [&](std::size_t i) {
+		return closed || (i > 0 && i + 1 < num_points);
+	};
+	
+	std::vector<double> costs(num_points);
+	auto const calculate_cost = [&](std::size_t i) {
+		auto const& start = points[prev[i]];
+		auto const& end = points[next[i]];
+		auto max_distance_sq = 0.0;
+		for (auto j = (prev[i] + 1) % num_points; j != next[i]; j = (j + 1) % num_points)
+			max_distance_sq = std::max(max_distance_sq, distanceSquaredToSegment(points[j], start, end));
+		return std::sqrt(max_distance_sq);
+	};
+	
+	// A min-heap of (cost, index). Outdated entries are skipped when popped.
+	using Candidate = std::pair<double, std::size_t>;
+	std::vector<Candidate> heap;
+	heap.reserve(num_points);
+	for (std::size_t i = 0; i < num_points; ++i)
+	{
+		if (is_deletable(i))
+		{
+			costs[i] = calculate_cost(i);
+			heap.emplace_back(costs[i], i);
+		}
+	}
+	std::make_heap(begin(heap), end(heap), std::greater<>());
+	
+	auto remaining = num_points;
+	while (!heap.empty() && remaining >= minimum_part_size)
+	{
+		std::pop_heap(begin(heap), end(heap), std::greater<>());
+		auto const candidate = heap.back();
+		heap.pop_back();
+		
+		auto const i = candidate.second;
+		if (!keep[i] || costs[i] != candidate.first)
+			continue;
+		if (candidate.first > threshold)
+			break;
+		
+		keep[i] = false;
+		--remaining;
+		next[prev[i]] = next[i];
+		prev[next[i]] = prev[i];
+		
+		for (auto neighbour : { prev[i], next[i] })
+		{
+			if (is_deletable(neighbour))
+			{
+				costs[neighbour] = calculate_cost(neighbour);
+				heap.emplace_back(costs[neighbour], neighbour);
+				std::push_heap(begin(heap), end(heap), std::greater<>());
+			}
+		}
+	}
+	
+	return keep;
+}
+
+
+}  // namespace
+
+
 bool PathObject::simplify(PathObject** undo_duplicate, double threshold)
 {
 	// A copy for reference and undo while this is modified.
@@ -2226,9 +2345,61 @@ bool PathObject::simplify(PathObject** undo_duplicate, double threshold)
 	// parts of the original object later for cost calculation.
 	// Note: curve handle indices may become incorrect, we don't need them.
 	std::vector<MapCoordVector::size_type> original_indices;
-	original_indices.resize(coords.size());
-	for (std::size_t i = 0, end = coords.size(); i < end; ++i)
-		original_indices[i] = i;
+	original_indices.reserve(coords.size());
+	
+	auto const has_curves = [this](const PathPart& part) {
+		return std::any_of(begin(coords) + part.first_index, begin(coords) + part.last_index, [](const MapCoord& coord) {
+			return coord.isCurveStart();
+		});
+	};
+	
+	// Parts without curves are simplified directly on the coordinates.
+	MapCoordVector simplified_coords;
+	simplified_coords.reserve(coords.size());
+	std::vector<MapCoordF> points;
+	for (const auto& part : path_parts)
+	{
+		if (has_curves(part))
+		{
+			for (auto i = part.first_index; i <= part.last_index; ++i)
+			{
+				simplified_coords.push_back(coords[i]);
+				original_indices.push_back(i);
+			}
+			continue;
+		}
+		
+		auto const num_nodes = part.last_index - part.first_index + (part.isClosed() ? 0 : 1);
+		points.clear();
+		for (auto i = part.first_index; i < part.first_index + num_nodes; ++i)
+			points.emplace_back(coords[i]);
+		
+		auto const keep = simplifyPolygonalPart(points, part.isClosed(), threshold);
+		auto const part_start = simplified_coords.size();
+		for (std::size_t i = 0; i < num_nodes; ++i)
+		{
+			if (keep[i])
+			{
+				simplified_coords.push_back(coords[part.first_index + i]);
+				original_indices.push_back(part.first_index + i);
+			}
+		}
+		if (part.isClosed())
+		{
+			// This must match PathObject::setClosingPoint
+			auto closing_point = simplified_coords[part_start];
+			closing_point.setCurveStart(false);
+			closing_point.setHolePoint(true);
+			closing_point.setClosePoint(true);
+			simplified_coords.push_back(closing_point);
+			original_indices.push_back(original_indices[part_start]);
+		}
+	}
+	if (simplified_coords.size() != coords.size())
+	{
+		coords.swap(simplified_coords);
+		recalculateParts();
+	}
 	
 	// A high value indicating an cost of deletion which is unknown.
 	auto const undetermined_cost = std::numeric_limits<double>::max();
@@ -2246,6 +2417,10 @@ bool PathObject::simplify(PathObject** undo_duplicate, double threshold)
 	
 	for (auto part = path_parts.rbegin(); part != path_parts.rend(); ++part)
 	{
+		// Parts without curves are done.
+		if (!has_curves(*part))
+			continue;
+		
 		// Don't simplify parts which would get deleted.
 		MapCoordVector::size_type minimum_part_size = part->isClosed() ? 4 : 3;
 		auto minimumPartSizeReached = [&part, minimum_part_size]() -> bool
@@ -2585,7 +2760,121 @@ void PathObject::Intersections::normalize()
 	erase(std::unique(begin(), end()), end());
 }
 
+namespace {
+
+/**
+ * An axis-aligned bounding box, including its border.
+ */
+struct SegmentBox
+{
+	double min_x, min_y, max_x, max_y;
+	
+	SegmentBox() = default;
+	
+	SegmentBox(const MapCoordF& p0, const MapCoordF& p1, double margin = 0)
+	: min_x { std::min(p0.x(), p1.x()) - margin }
+	, min_y { std::min(p0.y(), p1.y()) - margin }
+	, max_x { std::max(p0.x(), p1.x()) + margin }
+	, max_y { std::max(p0.y(), p1.y()) + margin }
+	{}
+	
+	bool overlaps(const SegmentBox& other) const
+	{
+		return min_x <= other.max_x && other.min_x <= max_x
+		       && min_y <= other.max_y && other.min_y <= max_y;
+	}
+	
+	void unite(const SegmentBox& other)
+	{
+		min_x = std::min(min_x, other.min_x);
+		min_y = std::min(min_y, other.min_y);
+		max_x = std::max(max_x, other.max_x);
+		max_y = std::max(max_y, other.max_y);
+	}
+};
+
+
+/**
+ * A bounding box hierarchy over the segments of a path part.
+ * 
+ * Each node covers a range of consecutive segments. Paths are spatially
+ * coherent, so the boxes of such ranges are tight, and a query visits
+ * only the segments near the given box.
+ * 
+ * The segment boxes are enlarged by a margin which covers the tolerances
+ * of the intersection tests in PathObject::calcAllIntersectionsWith().
+ */
+class SegmentBoxTree
+{
+public:
+	explicit SegmentBoxTree(const PathCoordVector& path_coords)
+	: num_segments { path_coords.size() > 1 ? path_coords.size() - 1 : 0 }
+	{
+		if (num_segments > 0)
+		{
+			boxes.resize(4 * num_segments);
+			build(path_coords, 1, 0, num_segments);
+		}
+	}
+	
+	/**
+	 * Calls visit(k) for each segment from path_coords[k-1] to path_coords[k]
+	 * which may overlap the given box, in ascending order of k.
+	 */
+	template <class Visitor>
+	void query(const SegmentBox& box, Visitor&& visit) const
+	{
+		if (num_segments > 0)
+			query(box, visit, 1, 0, num_segments);
+	}
+	
+private:
+	/// Generous compared to the 1e-5 of parameterOfPointOnLine().
+	static constexpr double margin = 0.01;
+	
+	void build(const PathCoordVector& path_coords, std::size_t node, std::size_t first, std::size_t last)
+	{
+		if (last - first == 1)
+		{
+			boxes[node] = SegmentBox(path_coords[first].pos, path_coords[last].pos, margin);
+			return;
+		}
+		auto const middle = first + (last - first) / 2;
+		build(path_coords, 2 * node, first, middle);
+		build(path_coords, 2 * node + 1, middle, last);
+		boxes[node] = boxes[2 * node];
+		boxes[node].unite(boxes[2 * node + 1]);
+	}
+	
+	template <class Visitor>
+	void query(const SegmentBox& box, Visitor& visit, std::size_t node, std::size_t first, std::size_t last) const
+	{
+		if (!boxes[node].overlaps(box))
+			return;
+		if (last - first == 1)
+		{
+			visit(PathCoordVector::size_type(last));
+			return;
+		}
+		auto const middle = first + (last - first) / 2;
+		query(box, visit, 2 * node, first, middle);
+		query(box, visit, 2 * node + 1, middle, last);
+	}
+	
+	std::size_t num_segments;
+	std::vector<SegmentBox> boxes;
+};
+
+
+}  // namespace
+
+
 void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::Intersections& out) const
+{
+	calcAllIntersectionsWith(other, out, true);
+}
+
+void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::Intersections& out, bool prune_segments) const
 {
 	update();
 	other->update();
@@ -2594,6 +2883,9 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 	const double zero_minus_epsilon = 0 - epsilon;
 	const double one_plus_epsilon = 1 + epsilon;
 	
+	// Segment trees for pruning the pairs of segments which cannot intersect
+	std::vector<std::unique_ptr<SegmentBoxTree>> other_trees(other->path_parts.size());
+	
 	for (size_t part_index = 0; part_index < path_parts.size(); ++part_index)
 	{
 		const PathPart& part = path_parts[part_index];
@@ -2642,8 +2934,8 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 			{
 				const PathPart& other_part = other->path_parts[part_index]; /// \todo FIXME: part_index or other_part_index ???
 				auto other_path_coord_end_index = other_part.path_coords.size() - 1;
-				for (auto k = PathCoordVector::size_type { 1 }; k <= other_path_coord_end_index; ++k)
-				{
+				
+				auto test_segments = [&](PathCoordVector::size_type k) {
 					// Test the two line segments against each other.
 					// Naming: segment in this path is a, segment in other path is b
 					const PathCoord& a0 = part.path_coords[i-1];
@@ -2693,7 +2985,7 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 						{
 							if (colliding) out.push_back(last_intersection);
 							colliding = false;
-							continue;
+							return;
 						}
 						double b_end = 1;
 						double a_end = parameterOfPointOnLine(a0.pos.x(), a0.pos.y(), a1.pos.x() - a0.pos.x(), a1.pos.y() - a0.pos.y(), b1.pos.x(), b1.pos.y(), ok);
@@ -2701,7 +2993,7 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 						{
 							if (colliding) out.push_back(last_intersection);
 							colliding = false;
-							continue;
+							return;
 						}
 						
 						// Cull ranges
@@ -2709,13 +3001,13 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 						{
 							if (colliding) out.push_back(last_intersection);
 							colliding = false;
-							continue;
+							return;
 						}
 						if (a_start > one_plus_epsilon && a_end > one_plus_epsilon)
 						{
 							if (colliding) out.push_back(last_intersection);
 							colliding = false;
-							continue;
+							return;
 						}
 						
 						// b overlaps somehow with a, check if we have to enter one or two collisions
@@ -2806,7 +3098,7 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 						{
 							if (colliding) out.push_back(last_intersection);
 							colliding = false;
-							continue;
+							return;
 						}
 						
 						double b = -(a0.pos.x()*a1.pos.y() - a1.pos.x()*a0.pos.y() - a0.pos.x()*b0.pos.y() + a0.pos.y()*b0.pos.x() + a1.pos.x()*b0.pos.y() - a1.pos.y()*b0.pos.x()) / denominator;
@@ -2814,7 +3106,7 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 						{
 							if (colliding) out.push_back(last_intersection);
 							colliding = false;
-							continue;
+							return;
 						}
 						
 						// Special case for overlapping (cloned / traced) polylines: check if b is parallel to adjacent direction.
@@ -2838,7 +3130,7 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 						if (dot >= 1 - epsilon)
 						{
 							colliding = (b > 0.5);
-							continue;
+							return;
 						}
 						
 						// Enter the intersection
@@ -2846,7 +3138,35 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 						out.push_back(last_intersection);
 						colliding = (b == 1);
 					}
+				};
+				
+				if (!prune_segments)
+				{
+					for (auto k = PathCoordVector::size_type { 1 }; k <= other_path_coord_end_index; ++k)
+						test_segments(k);
+					continue;
 				}
+				
+				auto& tree = other_trees[part_index];
+				if (!tree)
+					tree = std::make_unique<SegmentBoxTree>(other_part.path_coords);
+				
+				// Segments which are not tested would just end a collision,
+				// except at the start of the other part.
+				PathCoordVector::size_type previous_k = 0;
+				auto skip_segments = [&]() {
+					if (previous_k > 0 && colliding)
+						out.push_back(last_intersection);
+					colliding = false;
+				};
+				tree->query(SegmentBox(part.path_coords[i-1].pos, part.path_coords[i].pos), [&](PathCoordVector::size_type k) {
+					if (k > previous_k + 1)
+						skip_segments();
+					test_segments(k);
+					previous_k = k;
+				});
+				if (previous_k < other_path_coord_end_index)
+					skip_segments();
 			}
 		}
 	}
@@ -2856,14 +3176,48 @@ void PathObject::setCoordinate(MapCoordVector::size_type pos, const MapCoord& c)
 {
 	Q_ASSERT(pos < getCoordinateCount());
 	
+	// Changes which keep the structure of the path allow for an incremental
+	// update of the path coords, unless there are other pending changes.
+	auto const extend_dirty_coords = hasDirtyCoordsOnly();
+	auto incremental = extend_dirty_coords || !isOutputDirty();
+	
 	const PathPart& part = *findPartForIndex(pos);
 	if (part.isClosed() && pos == part.last_index)
 		pos = part.first_index;
+	
+	const MapCoord& old_coord = coords[pos];
+	incremental = incremental
+	              && old_coord.isCurveStart() == c.isCurveStart()
+	              && old_coord.isHolePoint() == c.isHolePoint()
+	              && old_coord.isClosePoint() == c.isClosePoint();
+	
 	coords[pos] = c;
 	if (part.isClosed() && pos == part.first_index)
 		setClosingPoint(part.last_index, c);
 	
+	if (incremental)
+	{
+		auto last = (part.isClosed() && pos == part.first_index) ? part.last_index : pos;
+		if (!extend_dirty_coords)
+		{
+			dirty_coords_first = pos;
+			dirty_coords_last = last;
+		}
+		else
+		{
+			dirty_coords_first = qMin(dirty_coords_first, pos);
+			dirty_coords_last = qMax(dirty_coords_last, last);
+		}
+	}
+	has_dirty_coords = incremental;
+	
 	setOutputDirty();
+	dirty_coords_count = outputDirtyCount();
+}
+
+bool PathObject::hasDirtyCoordsOnly() const
+{
+	return has_dirty_coords && dirty_coords_count == outputDirtyCount();
 }
 
 void PathObject::addCoordinate(MapCoordVector::size_type pos, const MapCoord& c)
@@ -3107,6 +3461,18 @@ void PathObject::assignCoordinates(const PathObject& proto, MapCoordVector::size
 
 void PathObject::updatePathCoords() const
 {
+	if (hasDirtyCoordsOnly())
+	{
+		has_dirty_coords = false;
+		for (auto& part : path_parts)
+		{
+			if (part.first_index <= dirty_coords_last && part.last_index >= dirty_coords_first)
+				part.path_coords.updateRange(dirty_coords_first, dirty_coords_last);
+		}
+		return;
+	}
+	
+	has_dirty_coords = false;
 	auto part_start = VirtualPath::size_type { 0 };
 	for (auto& part : path_parts)
 	{
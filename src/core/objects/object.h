@@ -10,6 +10,7 @@
 #ifndef LIBREMAPPER_OBJECT_H
 #define LIBREMAPPER_OBJECT_H
 
+#include <cstddef>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -31,6 +32,8 @@ class QXmlStreamReader;
 class QXmlStreamWriter;
 // IWYU pragma: no_forward_declare QRectF
 
+class PathObjectTest;
+
 namespace LibreMapper {
 
 class Map;
@@ -53,6 +56,7 @@ class VirtualCoordVector;
  */
 class Object  // clazy:exclude=copyable-polymorphic
 {
+friend class MapPart;
 friend class ObjectRenderables;
 friend class XMLImportExport;
 public:
@@ -310,6 +314,13 @@ protected:
 	
 	virtual void createRenderables(ObjectRenderables& output, Symbol::RenderableOptions options) const;
 	
+	/**
+	 * Returns the number of times the output was marked dirty.
+	 * 
+	 * Subclasses can use this value to detect other changes after their own.
+	 */
+	quint64 outputDirtyCount() const { return output_dirty_count; }
+	
 	Type type;
 	const Symbol* symbol = nullptr;
 	MapCoordVector coords;
@@ -319,6 +330,8 @@ protected:
 private:
 	qreal rotation = 0;               ///< The object's rotation (in radians).
 	mutable bool output_dirty = true; // does the output have to be re-generated because of changes?
+	quint64 output_dirty_count = 0;   // number of calls to setOutputDirty(true)
+	std::size_t map_part_index = 0;   // position in the MapPart, maintained by MapPart
 	mutable QRectF extent;            // only valid after calling update()
 	mutable ObjectRenderables output; // only valid after calling update()
 };
@@ -434,6 +447,7 @@ public:
 class PathObject : public Object  // clazy:exclude=copyable-polymorphic
 {
 	friend class PathPart;
+	friend class ::PathObjectTest;
 	
 public:
 	
@@ -993,6 +1007,20 @@ protected:
 	void createRenderables(ObjectRenderables& output, Symbol::RenderableOptions options) const override;
 	
 private:
+	/**
+	 * Returns true if the coordinates were changed only by setCoordinate()
+	 * since the last update of the path coords.
+	 */
+	bool hasDirtyCoordsOnly() const;
+	
+	/**
+	 * Implements calcAllIntersectionsWith().
+	 * 
+	 * If prune_segments is false, each segment is tested against all segments
+	 * of the other path. This is used for testing the pruning.
+	 */
+	void calcAllIntersectionsWith(const PathObject* other, Intersections& out, bool prune_segments) const;
+	
 	/**
 	 * Origin shift of the object pattern. Only used if the object
 	 * has a symbol which interprets this value.
@@ -1001,6 +1029,18 @@ private:
 	
 	/** Path parts list */
 	mutable PathPartVector path_parts;
+	
+	/**
+	 * The range of coordinates which were changed by setCoordinate() since
+	 * the last update of the path coords, if there were no other changes.
+	 * 
+	 * The range is valid only while dirty_coords_count matches the output
+	 * dirty count.
+	 */
+	mutable MapCoordVector::size_type dirty_coords_first = 0;
+	mutable MapCoordVector::size_type dirty_coords_last = 0;
+	mutable quint64 dirty_coords_count = 0;
+	mutable bool has_dirty_coords = false;
 };
 
 
@@ -1148,6 +1188,8 @@ inline
 void Object::setOutputDirty(bool dirty)
 {
 	output_dirty = dirty;
+	if (dirty)
+		++output_dirty_count;
 }
 
 inline
@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright 2026 LibreMapper contributors
+ *
+ * This file is part of LibreMapper.
+ */
+
+#include "object_selection.h"
+
+#include <algorithm>
+
+#include <QtGlobal>
+
+
+namespace LibreMapper {
+
+ObjectSelection::~ObjectSelection() = default;
+
+
+ObjectSelection::const_iterator ObjectSelection::find(const Object* object) const
+{
+	auto const index = indices.constFind(object);
+	if (index == indices.constEnd())
+		return end();
+	return begin() + *index;
+}
+
+
+bool ObjectSelection::insert(Object* object)
+{
+	auto const index = indices.constFind(object);
+	if (index != indices.constEnd())
+		return false;
+	
+	indices.insert(object, objects.size());
+	objects.push_back(object);
+	return true;
+}
+
+
+bool ObjectSelection::erase(const Object* object)
+{
+	auto const index = indices.find(object);
+	if (index == indices.end())
+		return false;
+	
+	auto const pos = *index;
+	indices.erase(index);
+	if (pos + 1 != objects.size())
+	{
+		objects[pos] = objects.back();
+		indices[objects[pos]] = pos;
+	}
+	objects.pop_back();
+	return true;
+}
+
+
+ObjectSelection::size_type ObjectSelection::eraseIf(const std::function<bool (const Object*)>& condition)
+{
+	auto const old_size = objects.size();
+	auto out = objects.begin();
+	for (auto* object : objects)
+	{
+		if (condition(object))
+		{
+			indices.remove(object);
+		}
+		else
+		{
+			if (*out != object)
+				indices[object] = size_type(out - objects.begin());
+			*out++ = object;
+		}
+	}
+	objects.erase(out, objects.end());
+	return old_size - objects.size();
+}
+
+
+void ObjectSelection::clear()
+{
+	objects.clear();
+	indices.clear();
+}
+
+
+void ObjectSelection::reserve(size_type size)
+{
+	objects.reserve(size);
+	indices.reserve(qsizetype(size));
+}
+
+
+}  // namespace LibreMapper
@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright 2026 LibreMapper contributors
+ *
+ * This file is part of LibreMapper.
+ */
+
+#ifndef LIBREMAPPER_OBJECT_SELECTION_H
+#define LIBREMAPPER_OBJECT_SELECTION_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <QHash>
+
+namespace LibreMapper {
+
+class Object;
+
+
+/**
+ * A set of object pointers, stored in a flat list.
+ * 
+ * Iteration visits the objects in the order of insertion, except that
+ * erase() moves the last object to the position of the erased one.
+ * Lookup, insertion and removal take constant time, and no memory is
+ * allocated per object.
+ */
+class ObjectSelection
+{
+public:
+	using value_type = Object*;
+	using size_type = std::size_t;
+	using const_iterator = std::vector<Object*>::const_iterator;
+	using iterator = const_iterator;
+	
+	ObjectSelection() = default;
+	ObjectSelection(const ObjectSelection&) = default;
+	ObjectSelection(ObjectSelection&&) = default;
+	~ObjectSelection();
+	
+	ObjectSelection& operator=(const ObjectSelection&) = default;
+	ObjectSelection& operator=(ObjectSelection&&) = default;
+	
+	bool empty() const noexcept { return objects.empty(); }
+	
+	size_type size() const noexcept { return objects.size(); }
+	
+	const_iterator begin() const noexcept { return objects.begin(); }
+	
+	const_iterator end() const noexcept { return objects.end(); }
+	
+	const_iterator cbegin() const noexcept { return objects.cbegin(); }
+	
+	const_iterator cend() const noexcept { return objects.cend(); }
+	
+	/**
+	 * Returns true if the object is contained in this set.
+	 */
+	bool contains(const Object* object) const { return indices.contains(object); }
+	
+	/**
+	 * Returns an iterator to the object, or end() if not found.
+	 */
+	const_iterator find(const Object* object) const;
+	
+	/**
+	 * Adds the object to the set.
+	 * 
+	 * @return True if the object was added, false if it was already contained.
+	 */
+	bool insert(Object* object);
+	
+	/**
+	 * Removes the object from the set.
+	 * 
+	 * @return True if the object was removed, false if it was not contained.
+	 */
+	bool erase(const Object* object);
+	
+	/**
+	 * Removes all objects matching the condition, preserving the order of
+	 * the remaining objects.
+	 * 
+	 * @return The number of removed objects.
+	 */
+	size_type eraseIf(const std::function<bool (const Object*)>& condition);
+	
+	/**
+	 * Removes all objects.
+	 */
+	void clear();
+	
+	/**
+	 * Prepares the set for holding the given number of objects.
+	 */
+	void reserve(size_type size);
+
+private:
+	std::vector<Object*> objects;
+	QHash<const Object*, size_type> indices;  ///< Positions in objects
+
+};
+
+
+}  // namespace LibreMapper
+
+#endif // LIBREMAPPER_OBJECT_SELECTION_H
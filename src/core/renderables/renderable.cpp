@@ -77,6 +77,12 @@ namespace LibreMapper {
 Renderable::~Renderable() = default;
 
 
+bool Renderable::chunksIntersect(const QRectF& /*rect*/) const
+{
+	return true;
+}
+
+
 
 // ### SharedRenderables ###
 
@@ -130,6 +130,8 @@ public:
 	
 	/**
 	 * Tests whether the renderable's extent intersects the given rect.
+	 * 
+	 * For chunked renderables, the extents of the chunks are tested, too.
 	 */
 	bool intersects(const QRectF& rect) const;
 	
@@ -146,9 +148,24 @@ public:
 	virtual void render(QPainter& painter, const RenderConfig& config) const = 0;
 	
 protected:
+	/**
+	 * Tests whether the chunks of a chunked renderable intersect the given rect.
+	 * 
+	 * This is called by intersects() only if the renderable is chunked and
+	 * its extent intersects the rect. The default implementation returns true.
+	 */
+	virtual bool chunksIntersect(const QRectF& rect) const;
+	
 	/** The color priority is a major attribute and cannot be modified. */
 	const int color_priority;
 	
+	/**
+	 * Indicates that the renderable is split into chunks with their own extents.
+	 * 
+	 * Inheriting classes set this flag to make intersects() test the chunks.
+	 */
+	bool chunked = false;
+	
 	/** The extent must be set by inheriting classes. */
 	QRectF extent;
 };
@@ -393,7 +410,7 @@ const QRectF&Renderable::getExtent() const
 inline
 bool Renderable::intersects(const QRectF& rect) const
 {
-	return extent.intersects(rect);
+	return extent.intersects(rect) && (!chunked || chunksIntersect(rect));
 }
 
 
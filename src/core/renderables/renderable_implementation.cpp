@@ -13,6 +13,7 @@
 #include <cstddef>
 #include <iterator>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <QtMath>
@@ -49,6 +50,12 @@
 
 namespace {
 
+/**
+ * The size (in mm) above which a line is culled in parts when rendering.
+ */
+constexpr qreal line_chunk_size = 100;
+
+
 /**
  * When painting to a PDF engine, the miter limit must be adjusted from Qt's
  * concept to PDF's concept. This should be done in the PDF engine, but this
@@ -141,6 +148,7 @@ void CircleRenderable::render(QPainter &painter, const RenderConfig &config) con
 LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virtual_path, bool closed)
  : Renderable(symbol->getColor())
  , line_width(0.001 * symbol->getLineWidth())
+ , closed(closed)
 {
 	Q_ASSERT(virtual_path.size() >= 2);
 	
@@ -264,6 +272,8 @@ LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virt
 		}
 	}
 	Q_ASSERT(extent.right() < 60000000);	// assert if bogus values are returned
+	
+	initChunks();
 }
 
 LineRenderable::LineRenderable(const LineSymbol* symbol, QPointF first, QPointF second)
@@ -286,6 +296,66 @@ LineRenderable::LineRenderable(const LineSymbol* symbol, QPointF first, QPointF
 	path.lineTo(second);
 }
 
+void LineRenderable::initChunks()
+{
+	// Only single subpaths are split. Gaps and holes are rare for long lines,
+	// and the regular clipping in render() handles them.
+	const int count = path.elementCount();
+	if (count <= 2 || qMax(extent.width(), extent.height()) <= 2 * line_chunk_size)
+		return;
+	for (int i = 1; i < count; ++i)
+	{
+		if (path.elementAt(i).isMoveTo())
+			return;
+	}
+	
+	// The margin covers caps and miter joins at the chunk boundaries.
+	const auto margin = qMax(line_width, qreal(0.0001));
+	auto chunk = Chunk { QRectF(QPointF(path.elementAt(0)), QSizeF()), 0, 0 };
+	for (int i = 1; i < count; ++i)
+	{
+		rectInclude(chunk.extent, QPointF(path.elementAt(i)));
+		if (path.elementAt(i).isCurveTo())
+		{
+			Q_ASSERT(i < count - 2);
+			rectInclude(chunk.extent, QPointF(path.elementAt(i + 1)));
+			rectInclude(chunk.extent, QPointF(path.elementAt(i + 2)));
+			i += 2;
+		}
+		
+		if (i < count - 1
+		    && qMax(chunk.extent.width(), chunk.extent.height()) < line_chunk_size)
+			continue;
+		
+		chunk.last = i;
+		chunk.extent.adjust(-margin, -margin, margin, margin);
+		chunks.push_back(chunk);
+		chunk = Chunk { QRectF(QPointF(path.elementAt(i)), QSizeF()), i, i };
+	}
+	
+	if (chunks.size() < 2)
+		chunks.clear();
+	chunks.shrink_to_fit();
+	chunked = !chunks.empty();
+}
+
+bool LineRenderable::chunksIntersect(const QRectF& rect) const
+{
+	// The chunk extents include the line width.
+	return std::any_of(begin(chunks), end(chunks), [&rect](const auto& chunk) {
+		return chunk.extent.intersects(rect);
+	});
+}
+
+std::vector<QRectF> LineRenderable::chunkExtents() const
+{
+	std::vector<QRectF> extents;
+	extents.reserve(chunks.size());
+	for (const auto& chunk : chunks)
+		extents.push_back(chunk.extent);
+	return extents;
+}
+
 void LineRenderable::extentIncludeCap(quint32 i, qreal half_line_width, bool end_cap, const LineSymbol* symbol, const VirtualPath& path)
 {
 	const auto& coord = path.coords[i];
@@ -454,7 +524,12 @@ void LineRenderable::render(QPainter &painter, const RenderConfig &config) const
 	// One-time adjustment for line width
 	QRectF bounding_box = config.bounding_box.adjusted(-line_width, -line_width, line_width, line_width);
 	const int count = path.elementCount();
-	if (count <= 2 || bounding_box.contains(path.controlPointRect()))
+	if (!chunks.empty())
+	{
+		// long path, the chunk extents include the line width
+		renderChunks(painter, config.bounding_box);
+	}
+	else if (count <= 2 || bounding_box.contains(path.controlPointRect()))
 	{
 		// path fully contained
 		painter.drawPath(path);
@@ -602,6 +677,70 @@ void LineRenderable::render(QPainter &painter, const RenderConfig &config) const
 	painter.setPen(pen);*/
 }
 
+void LineRenderable::renderChunks(QPainter& painter, const QRectF& bounding_box) const
+{
+	// Collect the runs of consecutive visible chunks, as [first, last) pairs.
+	std::vector<std::pair<std::size_t, std::size_t>> runs;
+	for (std::size_t i = 0; i < chunks.size(); ++i)
+	{
+		if (!chunks[i].extent.intersects(bounding_box))
+			continue;
+		if (runs.empty() || runs.back().second != i)
+			runs.emplace_back(i, i + 1);
+		else
+			runs.back().second = i + 1;
+	}
+	if (runs.empty())
+		return;
+	
+	if (runs.front().first == 0 && runs.front().second == chunks.size())
+	{
+		painter.drawPath(path);
+		return;
+	}
+	
+	// Each run is drawn as one subpath, with the original joins. The ends of
+	// a run lie in invisible chunks, so the caps there are not visible.
+	QPainterPath part_path;
+	auto const add_elements = [this, &part_path](int first, int last) {
+		for (int i = first + 1; i <= last; ++i)
+		{
+			const auto element = path.elementAt(i);
+			if (element.isCurveTo())
+			{
+				part_path.cubicTo(element, path.elementAt(i + 1), path.elementAt(i + 2));
+				i += 2;
+			}
+			else
+			{
+				part_path.lineTo(element);
+			}
+		}
+	};
+	
+	// For a closed path, a run which includes the closing point continues
+	// with the run at the start of the path.
+	const int count = path.elementCount();
+	if (closed && runs.size() > 1 && runs.front().first == 0 && runs.back().second == chunks.size())
+	{
+		const auto& first_chunk = chunks[runs.back().first];
+		part_path.moveTo(path.elementAt(first_chunk.first));
+		add_elements(first_chunk.first, count - 1);
+		add_elements(0, chunks[runs.front().second - 1].last);
+		runs.pop_back();
+		runs.erase(runs.begin());
+	}
+	
+	for (const auto& run : runs)
+	{
+		const auto& first_chunk = chunks[run.first];
+		part_path.moveTo(path.elementAt(first_chunk.first));
+		add_elements(first_chunk.first, chunks[run.second - 1].last);
+	}
+	
+	painter.drawPath(part_path);
+}
+
 // ### AreaRenderable ###
 
 AreaRenderable::AreaRenderable(const AreaSymbol* symbol, const PathPartVector& path_parts)
@@ -10,6 +10,8 @@
 #ifndef LIBREMAPPER_RENDERABLE_IMPLEMENTATION_H
 #define LIBREMAPPER_RENDERABLE_IMPLEMENTATION_H
 
+#include <vector>
+
 #include <Qt>
 #include <QtGlobal>
 #include <QPainterPath>
@@ -65,7 +67,36 @@ public:
 	void render(QPainter& painter, const RenderConfig& config) const override;
 	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
 	
+	/**
+	 * Returns the extents of the parts of a long line which are culled
+	 * separately, or an empty vector.
+	 * 
+	 * MapRenderables skips the line if none of these extents intersects the
+	 * area to be drawn, and render() draws only the intersecting chunks.
+	 * Dirty areas still cover the whole extent of the line.
+	 */
+	std::vector<QRectF> chunkExtents() const;
+	
 protected:
+	/**
+	 * A range of path elements which is tested against the bounding box
+	 * on its own.
+	 * 
+	 * Neighbouring chunks share their boundary vertex.
+	 */
+	struct Chunk
+	{
+		QRectF extent;  ///< Including the line width
+		int first;      ///< The element index of the first vertex
+		int last;       ///< The element index of the last vertex
+	};
+	
+	void initChunks();
+	
+	bool chunksIntersect(const QRectF& rect) const override;
+	
+	void renderChunks(QPainter& painter, const QRectF& bounding_box) const;
+	
 	void extentIncludeCap(quint32 i, qreal half_line_width, bool end_cap, const LineSymbol* symbol, const VirtualPath& path);
 	
 	void extentIncludeJoin(quint32 i, qreal half_line_width, const LineSymbol* symbol, const VirtualPath& path);
@@ -74,6 +105,8 @@ protected:
 	QPainterPath path;
 	Qt::PenCapStyle cap_style;
 	Qt::PenJoinStyle join_style;
+	bool closed = false;
+	std::vector<Chunk> chunks;
 };
 
 /** Renderable for displaying an area. */
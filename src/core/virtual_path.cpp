@@ -9,6 +9,10 @@
 
 #include "virtual_path.h"
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "util/util.h"
 
 
@@ -89,22 +93,11 @@ VirtualCoordVector::size_type PathCoordVector::update(VirtualCoordVector::size_t
 		
 		emplace_back(virtual_coords[part_start], part_start, 0.0, 0.0);
 		
-		for (auto index = part_start + 1; index <= part_end; ++index)
+		for (auto index = part_start; index < part_end; )
 		{
-			if (flags[index-1].isCurveStart())
-			{
-				Q_ASSERT(index+2 <= part_end);
-				
-				// Add curve coordinates
-				curveToPathCoord(virtual_coords[index-1], virtual_coords[index], virtual_coords[index+1], virtual_coords[index+2], index-1, 0, 1);
-				index += 2;
-			}
-			
-			// Add end point
-			const PathCoord& prev = back();
-			emplace_back(virtual_coords[index], index, 0.0, prev.clen + prev.pos.distanceTo(virtual_coords[index]));
+			Q_ASSERT(!flags[index].isCurveStart() || index+3 <= part_end);
 			
-			Q_ASSERT(back().index == index);
+			index = addEdge(index);
 			
 			if (index < part_end && flags[index].isHolePoint())
 			{
@@ -115,6 +108,59 @@ VirtualCoordVector::size_type PathCoordVector::update(VirtualCoordVector::size_t
 	return part_end;
 }
 
+void PathCoordVector::updateRange(VirtualCoordVector::size_type first, VirtualCoordVector::size_type last)
+{
+	Q_ASSERT(!empty());
+	first = qMax(first, VirtualCoordVector::size_type(front().index));
+	last  = qMin(last, VirtualCoordVector::size_type(back().index));
+	if (first > last)
+		return;
+	
+	// Find the start of the edge which ends at or contains first,
+	// and the end of the edge which starts at or contains last.
+	auto const range_begin = std::lower_bound(begin(), end(), first, PathCoord::indexLessThanValue);
+	auto const edge_start = (range_begin == begin()) ? first : std::prev(range_begin)->index;
+	auto const edge_begin = std::lower_bound(begin(), range_begin, edge_start, PathCoord::indexLessThanValue);
+	auto edge_end = std::lower_bound(range_begin, end(), last + 1, PathCoord::indexLessThanValue);
+	if (edge_end == end())
+		--edge_end;
+	Q_ASSERT(edge_begin->param == 0);
+	Q_ASSERT(edge_end->param == 0);
+	
+	auto const end_index = VirtualCoordVector::size_type(edge_end->index);
+	auto const old_length = edge_end->clen;
+	std::vector<PathCoord> tail(edge_end + 1, end());
+	erase(edge_begin + 1, end());
+	
+	back().pos = virtual_coords[edge_start];
+	for (auto index = VirtualCoordVector::size_type(edge_start); index < end_index; )
+		index = addEdge(index);
+	Q_ASSERT(back().index == end_index);
+	
+	auto const delta = back().clen - old_length;
+	for (auto& path_coord : tail)
+		path_coord.clen += delta;
+	insert(end(), begin(tail), end(tail));
+}
+
+VirtualCoordVector::size_type PathCoordVector::addEdge(VirtualCoordVector::size_type start)
+{
+	auto index = start + 1;
+	if (virtual_coords.flags[start].isCurveStart())
+	{
+		// Add curve coordinates
+		curveToPathCoord(virtual_coords[start], virtual_coords[start+1], virtual_coords[start+2], virtual_coords[start+3], start, 0, 1);
+		index = start + 3;
+	}
+	
+	// Add end point
+	const PathCoord& prev = back();
+	emplace_back(virtual_coords[index], index, 0.0, prev.clen + prev.pos.distanceTo(virtual_coords[index]));
+	
+	Q_ASSERT(back().index == index);
+	return index;
+}
+
 bool PathCoordVector::isClosed() const
 {
 	return virtual_coords.flags[back().index].isClosePoint();
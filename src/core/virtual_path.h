@@ -65,6 +65,15 @@ public:
 	 */
 	VirtualCoordVector::size_type update(VirtualCoordVector::size_type first);
 	
+	/**
+	 * Updates the path coords after changes to the coords from first to last.
+	 * 
+	 * The flags must be the same as in the last call to update(first).
+	 * Only the edges touching the changed coords are recalculated. The lengths
+	 * of the following path coords are shifted by the change in length.
+	 */
+	void updateRange(VirtualCoordVector::size_type first, VirtualCoordVector::size_type last);
+	
 	
 	/**
 	 * Finds the index of the next dash point after first, or returns size()-1.
@@ -110,6 +119,15 @@ public:
 	bool isPointInside(const MapCoordF& coord) const;
 	
 private:
+	/**
+	 * Adds the path coords for the edge which starts at the given index.
+	 * 
+	 * The path coord for the start of the edge must already be the last one.
+	 * 
+	 * \return The index of the end of the edge.
+	 */
+	VirtualCoordVector::size_type addEdge(VirtualCoordVector::size_type start);
+	
 	/**
 	 * Recursive approximation of a bezier curve by polygonal segments.
 	 */
@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#include "binary_file_format.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+#include <QBuffer>
+#include <QByteArray>
+#include <QFileDevice>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QScopeGuard>
+#include <QString>
+
+#include "fileformats/file_format.h"
+#include "fileformats/file_import_export.h"
+#include "fileformats/xml_file_format_p.h"
+#include "util/xml_stream_util.h"
+
+
+namespace LibreMapper {
+
+namespace {
+
+/// The file signature, modeled after PNG: binary, and detecting newline conversions.
+constexpr std::array<char, 8> signature = { '\x89', 'L', 'M', 'B', '\r', '\n', '\x1a', '\n' };
+
+/// Sections start at multiples of this value, for aligned access to the mapping.
+constexpr quint64 section_alignment = 8;
+
+struct FileHeader
+{
+	std::array<char, 8> signature;
+	quint32 version;
+	quint32 num_sections;
+};
+
+struct SectionEntry
+{
+	quint32 type;
+	quint32 reserved;
+	quint64 offset;
+	quint64 size;
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader must not have padding");
+static_assert(sizeof(SectionEntry) == 24, "SectionEntry must not have padding");
+
+
+quint64 aligned(quint64 pos)
+{
+	return (pos + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+
+
+/**
+ * Map exporter for the binary map format.
+ * 
+ * The map document is written by the XML exporter, with the coordinates
+ * diverted to columns via XmlCoordColumns.
+ */
+class BinaryFileExporter : public XMLFileExporter
+{
+public:
+	using XMLFileExporter::XMLFileExporter;
+	
+protected:
+	bool exportImplementation() override;
+};
+
+bool BinaryFileExporter::exportImplementation()
+{
+	XmlCoordColumns columns;
+	QBuffer document;
+	document.open(QIODevice::WriteOnly);
+	{
+		XmlCoordColumns::Scope const active_columns { columns };
+		auto* const target = device();
+		setDevice(&document);
+		auto const restore_device = qScopeGuard([this, target]() { setDevice(target); });
+		if (!XMLFileExporter::exportImplementation())
+			return false;
+	}
+	document.close();
+	
+	auto const num_coords = quint64(columns.size());
+	auto const sections = std::array<SectionEntry, 4> {{
+	    { BinaryFileFormat::DocumentSection,   0, 0, quint64(document.data().size()) },
+	    { BinaryFileFormat::CoordXSection,     0, 0, num_coords * sizeof(qint32) },
+	    { BinaryFileFormat::CoordYSection,     0, 0, num_coords * sizeof(qint32) },
+	    { BinaryFileFormat::CoordFlagsSection, 0, 0, num_coords * sizeof(quint8) },
+	}};
+	auto const section_data = std::array<const char*, 4> {
+	    document.data().constData(),
+	    reinterpret_cast<const char*>(columns.x()),
+	    reinterpret_cast<const char*>(columns.y()),
+	    reinterpret_cast<const char*>(columns.flags()),
+	};
+	
+	auto header = FileHeader { signature, quint32(BinaryFileFormat::current_version), quint32(sections.size()) };
+	auto table = sections;
+	auto pos = aligned(sizeof(FileHeader) + sizeof(table));
+	for (auto& entry : table)
+	{
+		entry.offset = pos;
+		pos = aligned(pos + entry.size);
+	}
+	
+	auto* const out = device();
+	auto write = [out](const char* bytes, qint64 size) {
+		if (out->write(bytes, size) != size)
+			throw FileFormatException(out->errorString());
+	};
+	write(reinterpret_cast<const char*>(&header), sizeof(header));
+	write(reinterpret_cast<const char*>(table.data()), sizeof(table));
+	pos = sizeof(FileHeader) + sizeof(table);
+	auto const padding = std::array<char, section_alignment> {};
+	for (std::size_t i = 0; i < table.size(); ++i)
+	{
+		write(padding.data(), qint64(table[i].offset - pos));
+		write(section_data[i], qint64(table[i].size));
+		pos = table[i].offset + table[i].size;
+	}
+	return true;
+}
+
+
+
+/**
+ * Map importer for the binary map format.
+ * 
+ * The file is memory-mapped if possible. The map document section is read
+ * by the XML importer, copying the coordinates from the mapped columns.
+ */
+class BinaryFileImporter : public XMLFileImporter
+{
+public:
+	using XMLFileImporter::XMLFileImporter;
+	
+protected:
+	bool importImplementation() override;
+};
+
+bool BinaryFileImporter::importImplementation()
+{
+	auto* const file = qobject_cast<QFileDevice*>(device());
+	auto* const mapping = (file && file->size() > 0) ? file->map(0, file->size()) : nullptr;
+	auto const unmap = qScopeGuard([file, mapping]() {
+		if (mapping)
+			file->unmap(mapping);
+	});
+	auto const data = mapping ? QByteArray::fromRawData(reinterpret_cast<const char*>(mapping), file->size())
+	                          : device()->readAll();
+	auto const size = quint64(data.size());
+	
+	FileHeader header;
+	if (size < sizeof(header))
+		throw FileFormatException(::LibreMapper::Importer::tr("Unsupported file format."));
+	std::memcpy(&header, data.constData(), sizeof(header));
+	if (header.signature != signature)
+		throw FileFormatException(::LibreMapper::Importer::tr("Unsupported file format."));
+	if (header.version > quint32(BinaryFileFormat::current_version))
+		throw FileFormatException(::LibreMapper::Importer::tr("Unsupported new file format version. Some map features will not be loaded or saved by this version of the program."));
+	if (header.num_sections > (size - sizeof(header)) / sizeof(SectionEntry))
+		throw FileFormatException(::LibreMapper::Importer::tr("Invalid data."));
+	
+	auto section_data = std::array<const char*, 5> {};
+	auto section_size = std::array<quint64, 5> {};
+	for (quint32 i = 0; i < header.num_sections; ++i)
+	{
+		SectionEntry entry;
+		std::memcpy(&entry, data.constData() + sizeof(header) + i * sizeof(SectionEntry), sizeof(entry));
+		if (entry.offset > size || entry.size > size - entry.offset || entry.offset % section_alignment != 0)
+			throw FileFormatException(::LibreMapper::Importer::tr("Invalid data."));
+		if (entry.type >= section_data.size())
+			continue;  // Unknown section, from a future version
+		section_data[entry.type] = data.constData() + entry.offset;
+		section_size[entry.type] = entry.size;
+	}
+	
+	auto const num_coords = section_size[BinaryFileFormat::CoordFlagsSection];
+	if (!section_data[BinaryFileFormat::DocumentSection]
+	    || section_size[BinaryFileFormat::CoordXSection] != num_coords * sizeof(qint32)
+	    || section_size[BinaryFileFormat::CoordYSection] != num_coords * sizeof(qint32))
+	{
+		throw FileFormatException(::LibreMapper::Importer::tr("Invalid data."));
+	}
+	
+	XmlCoordColumns columns {
+	    reinterpret_cast<const qint32*>(section_data[BinaryFileFormat::CoordXSection]),
+	    reinterpret_cast<const qint32*>(section_data[BinaryFileFormat::CoordYSection]),
+	    reinterpret_cast<const quint8*>(section_data[BinaryFileFormat::CoordFlagsSection]),
+	    std::size_t(num_coords)
+	};
+	XmlCoordColumns::Scope const active_columns { columns };
+	
+	QBuffer document;
+	document.setData(QByteArray::fromRawData(section_data[BinaryFileFormat::DocumentSection],
+	                                         qsizetype(section_size[BinaryFileFormat::DocumentSection])));
+	document.open(QIODevice::ReadOnly);
+	auto* const source = device();
+	setDevice(&document);
+	auto const restore_device = qScopeGuard([this, source]() { setDevice(source); });
+	return XMLFileImporter::importImplementation();
+}
+
+
+}  // namespace
+
+
+
+// ### BinaryFileFormat ###
+
+BinaryFileFormat::BinaryFileFormat()
+ : FileFormat(MapFile,
+              "Binary",
+              ::LibreMapper::ImportExport::tr("LibreMapper binary map"),
+              QString::fromLatin1("omapb"),
+              Feature::FileOpen | Feature::FileImport |
+              Feature::FileSave | Feature::FileSaveAs )
+{
+	// nothing else
+}
+
+
+FileFormat::ImportSupportAssumption BinaryFileFormat::understands(const char* buffer, int size) const
+{
+	if (size >= int(signature.size()) && std::memcmp(buffer, signature.data(), signature.size()) == 0)
+		return FullySupported;
+	return NotSupported;
+}
+
+
+std::unique_ptr<Importer> BinaryFileFormat::makeImporter(const QString& path, Map* map, MapView* view) const
+{
+	return std::make_unique<BinaryFileImporter>(path, map, view);
+}
+
+std::unique_ptr<Exporter> BinaryFileFormat::makeExporter(const QString& path, const Map* map, const MapView* view) const
+{
+	return std::make_unique<BinaryFileExporter>(path, map, view);
+}
+
+
+}  // namespace LibreMapper
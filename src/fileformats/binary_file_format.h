@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#ifndef LIBREMAPPER_BINARY_FILE_FORMAT_H
+#define LIBREMAPPER_BINARY_FILE_FORMAT_H
+
+#include <memory>
+
+#include <QString>
+
+#include "fileformats/file_format.h"
+
+namespace LibreMapper {
+
+class Exporter;
+class Importer;
+class Map;
+class MapView;
+
+
+/**
+ * The native binary map container format.
+ * 
+ * A file starts with a header and a section table. The map document section
+ * holds the regular XML map document, but without coordinate text. The
+ * coordinates are stored in separate columns of native x, y and flag values.
+ * On import, the file is memory-mapped, and the coordinates are copied from
+ * the mapping without any text parsing. The mapping is released when the
+ * import is finished.
+ * 
+ * All parts of the document, including the undo history, are decoded when
+ * the file is loaded. There is no lazy decoding of sections yet.
+ * 
+ * The format is not registered in FileFormats. Its layout is not final:
+ * colors, symbols, parts, templates and undo steps are meant to get their
+ * own sections, for lazy decoding. Until then, files in this format must
+ * not be created by users, so that no migration of that layout is needed.
+ * 
+ * \see XMLFileFormat, XmlCoordColumns
+ */
+class BinaryFileFormat : public FileFormat
+{
+public:
+	/**
+	 * The types of sections in a binary map file.
+	 */
+	enum SectionType
+	{
+		DocumentSection = 1,   ///< The XML map document
+		CoordXSection   = 2,   ///< qint32 native x coordinates
+		CoordYSection   = 3,   ///< qint32 native y coordinates
+		CoordFlagsSection = 4  ///< quint8 coordinate flags
+	};
+	
+	/**
+	 * Creates a new binary map file format.
+	 */
+	BinaryFileFormat();
+	
+	
+	/**
+	 * Returns true for data starting with the binary map file signature.
+	 */
+	ImportSupportAssumption understands(const char* buffer, int size) const override;
+	
+	
+	/**
+	 * Creates an importer for binary map files.
+	 */
+	std::unique_ptr<Importer> makeImporter(const QString& path, Map* map, MapView* view) const override;
+	
+	/**
+	 * Creates an exporter for binary map files.
+	 */
+	std::unique_ptr<Exporter> makeExporter(const QString& path, const Map* map, const MapView* view) const override;
+	
+	
+	/**
+	 * The version of the container layout created by this implementation.
+	 */
+	static constexpr int current_version = 1;
+
+};
+
+
+}  // namespace LibreMapper
+
+#endif // LIBREMAPPER_BINARY_FILE_FORMAT_H
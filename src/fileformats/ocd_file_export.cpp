@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <exception>
 #include <iterator>
 #include <memory>
 #include <utility>
@@ -76,6 +77,7 @@
 #include "fileformats/ocd_types_v2018.h"
 #include "templates/template.h"
 #include "templates/template_map.h"
+#include "util/concurrency.h"
 #include "util/encoding.h"
 #include "util/util.h"
 
@@ -93,6 +95,10 @@ static QTextCodec* codecFromSettings()
 }
 
 
+/// The number of objects which a thread takes at once when encoding objects.
+constexpr std::size_t objects_per_chunk = 256;
+
+
 
 /**
  * Returns the index of the first color which can be assumed to be a pure spot color.
@@ -2466,47 +2472,92 @@ void OcdFileExport::exportObjects(OcdFile<Format>& file)
 	for (int l = 0; l < map->getNumParts(); ++l)
 	{
 		auto part = map->getPart(std::size_t(l));
-		for (int o = 0; o < part->getNumObjects(); ++o)
+		auto const num_objects = std::size_t(part->getNumObjects());
+		
+		// Prepare the objects on this thread, because update() may modify the map.
+		std::vector<std::unique_ptr<Object>> duplicates(num_objects);
+		std::vector<const Object*> objects(num_objects);
+		for (std::size_t o = 0; o < num_objects; ++o)
 		{
-			const auto* object = part->getObject(o);
-			
-			std::unique_ptr<Object> duplicate;
+			const auto* object = part->getObject(int(o));
 			if (area_offset.nativeX() != 0 || area_offset.nativeY() != 0)
 			{
 				// Create a safely managed duplicate and move it as needed.
-				duplicate.reset(object->duplicate());
-				duplicate->move(-area_offset);  /// \todo move pattern origin etc.
-				object = duplicate.get();
+				duplicates[o].reset(object->duplicate());
+				duplicates[o]->move(-area_offset);  /// \todo move pattern origin etc.
+				object = duplicates[o].get();
 			}
 			object->update();
+			objects[o] = object;
+		}
+		
+		// Encode point and path objects concurrently, in chunks of objects.
+		std::vector<ObjectRecords<Format>> records(num_objects);
+		processConcurrently(num_objects, objects_per_chunk, [&](std::size_t first, std::size_t last, std::size_t /*worker*/) {
+			for (auto o = first; o < last; ++o)
+			{
+				try
+				{
+					encodeObject(records[o], objects[o]);
+				}
+				catch (...)
+				{
+					records[o].error = std::current_exception();
+				}
+			}
+		});
+		
+		// Add all objects in map order.
+		for (std::size_t o = 0; o < num_objects; ++o)
+		{
+			auto& object_records = records[o];
+			if (object_records.error)
+				std::rethrow_exception(object_records.error);
 			
-			QByteArray ocd_object;
-			auto entry = typename Format::Object::IndexEntryType {};
-			
-			switch (object->getType())
+			if (objects[o]->getType() == Object::Text)
 			{
-			case Object::Point:
-				ocd_object = exportPointObject<typename Format::Object>(static_cast<const PointObject*>(object), entry);
-				FILEFORMAT_ASSERT(!ocd_object.isEmpty());
-				file.objects().insert(ocd_object, entry);
-				break;
-				
-			case Object::Path:
-				exportPathObject<Format>(file, static_cast<const PathObject*>(object));
-				break;
-				
-			case Object::Text:
-				ocd_object = exportTextObject<typename Format::Object>(static_cast<const TextObject*>(object), entry);
+				// Text export may add warnings, so it is done on this thread.
+				auto entry = typename Format::Object::IndexEntryType {};
+				auto ocd_object = exportTextObject<typename Format::Object>(static_cast<const TextObject*>(objects[o]), entry);
 				FILEFORMAT_ASSERT(!ocd_object.isEmpty());
 				file.objects().insert(ocd_object, entry);
-				break;
+				continue;
 			}
 			
+			for (auto const& warning : object_records.warnings)
+				addWarning(warning);
+			for (auto const& record : object_records.objects)
+				file.objects().insert(record.first, record.second);
+			object_records = {};
 		}
 	}
 }
 
 
+template< class Format >
+void OcdFileExport::encodeObject(ObjectRecords<Format>& records, const Object* object)
+{
+	switch (object->getType())
+	{
+	case Object::Point:
+		{
+			auto entry = typename Format::Object::IndexEntryType {};
+			auto ocd_object = exportPointObject<typename Format::Object>(static_cast<const PointObject*>(object), entry);
+			FILEFORMAT_ASSERT(!ocd_object.isEmpty());
+			records.objects.emplace_back(std::move(ocd_object), entry);
+		}
+		break;
+		
+	case Object::Path:
+		exportPathObject<Format>(records, static_cast<const PathObject*>(object));
+		break;
+		
+	case Object::Text:
+		break;  // Handled by exportObjects()
+	}
+}
+
+
 /**
  * Object setup which depends on the type features, not on minor type variations of members.
  */
@@ -2594,7 +2645,7 @@ QByteArray OcdFileExport::exportPointObject(const PointObject* point, typename O
 
 
 template< class Format >
-void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* path, bool lines_only)
+void OcdFileExport::exportPathObject(ObjectRecords<Format>& records, const PathObject* path, bool lines_only)
 {
 	typename Format::Object ocd_object = {};
 	typename Format::Object::IndexEntryType entry = {};
@@ -2611,7 +2662,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 			if (static_cast<const AreaSymbol*>(symbol)->hasRotatableFillPattern())
 				ocd_object.angle = decltype(ocd_object.angle)(convertRotation(path->getPatternRotation()));
 			if (path->getPatternOrigin() != MapCoord(0, 0))
-				addWarning(::LibreMapper::OcdFileExport::tr("Unable to export fill pattern shift for an area object"));
+				records.warnings.push_back(::LibreMapper::OcdFileExport::tr("Unable to export fill pattern shift for an area object"));
 		}
 	}
 	else
@@ -2633,7 +2684,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 		if (breakdown_index_entry == end(breakdown_index))
 		{
 			// Regular symbol which does not need to be split
-			file.objects().insert(data, entry);
+			records.objects.emplace_back(std::move(data), entry);
 			return;
 		}
 		
@@ -2668,7 +2719,8 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 				exported_ocd_object.symbol = entry.symbol = decltype(entry.symbol)(breakdown->number);
 				exported_ocd_object.type = decltype(exported_ocd_object.type)(breakdown->type);
 				handleObjectExtras(path, exported_ocd_object, entry);  // update entry.type if it exists
-				file.objects().insert(data, entry);
+				// Deep copy: exported_ocd_object refers to data's buffer.
+				records.objects.emplace_back(QByteArray(data.constData(), data.size()), entry);
 			}
 			
 			if (backlog.empty())
@@ -2686,7 +2738,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 			PathObject split_line{part};
 			split_line.setSymbol(path->getSymbol(), true);
 			split_line.update();
-			exportPathObject(file, &split_line, true);
+			exportPathObject(records, &split_line, true);
 		}
 	}
 	
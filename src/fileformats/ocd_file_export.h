@@ -11,9 +11,11 @@
 #define LIBREMAPPER_OCD_FILE_EXPORT_H
 
 #include <cstddef>
+#include <exception>
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <QtGlobal>
@@ -108,6 +110,20 @@ class OcdFileExport : public Exporter
 	
 	using StringAppender = void (qint32, const QString&);
 	
+	/**
+	 * The OCD objects created for a single map object.
+	 * 
+	 * A map object may result in multiple OCD objects, e.g. for combined
+	 * symbols, or for lines with multiple parts.
+	 */
+	template< class Format >
+	struct ObjectRecords
+	{
+		std::vector<std::pair<QByteArray, typename Format::Object::IndexEntryType>> objects;
+		std::vector<QString> warnings;
+		std::exception_ptr error;
+	};
+	
 	struct TextFormatMapping;
 	
 public:
@@ -245,6 +261,14 @@ protected:
 	template< class Format >
 	void exportObjects(OcdFile<Format>& file);
 	
+	/**
+	 * Encodes a point or path object, for concurrent use by exportObjects().
+	 * 
+	 * Text objects are not handled here.
+	 */
+	template< class Format >
+	void encodeObject(ObjectRecords<Format>& records, const Object* object);
+	
 	template< class OcdObject >
 	void fillV9ObjectExtras(const Object* object, OcdObject& ocd_object, typename OcdObject::IndexEntryType& entry);
 	
@@ -258,7 +282,7 @@ protected:
 	QByteArray exportPointObject(const PointObject* point, typename OcdObject::IndexEntryType& entry);
 	
 	template< class Format >
-	void exportPathObject(OcdFile<Format>& file, const PathObject* path, bool lines_only = false);
+	void exportPathObject(ObjectRecords<Format>& records, const PathObject* path, bool lines_only = false);
 	
 	template< class OcdObject >
 	QByteArray exportTextObject(const TextObject* text, typename OcdObject::IndexEntryType& entry);
@@ -27,6 +27,7 @@
 #include <QDate>
 #include <QDebug>
 #include <QDir>
+#include <QFileDevice>
 #include <QFlags>
 #include <QFontMetricsF>
 #include <QIODevice>
@@ -34,6 +35,7 @@
 #include <QLatin1Char>
 #include <QLatin1String>
 #include <QPointF>
+#include <QScopeGuard>
 #include <QStringRef>
 #include <QTextCodec>
 #include <QTextDecoder>
@@ -68,6 +70,7 @@
 #include "templates/template.h"
 #include "templates/template_map.h"
 #include "templates/template_placeholder.h"
+#include "util/concurrency.h"
 #include "util/encoding.h"
 #include "util/util.h"
 
@@ -84,6 +87,10 @@ static QTextCodec* codecFromSettings()
 }	
 
 
+/// The number of objects which a thread takes at once when decoding objects.
+constexpr std::size_t objects_per_chunk = 256;
+
+
 }  // namespace
 
 
@@ -835,14 +842,13 @@ void OcdFileImport::importObjects(const OcdFile<Ocd::FormatV8>& file)
 	MapPart* part = map->getCurrentPart();
 	FILEFORMAT_ASSERT(part);
 	
+	std::vector<const Ocd::ObjectV8*> ocd_objects;
 	for (auto ocd_object : file.objects())
 	{
 		if (ocd_object.entry->symbol)
-		{
-			if (auto object = importObject(*ocd_object.entity, part))
-				part->addObject(object, part->getNumObjects());
-		}
+			ocd_objects.push_back(ocd_object.entity);
 	}
+	importObjects(ocd_objects, part);
 }
 
 template< class F >
@@ -851,16 +857,17 @@ void OcdFileImport::importObjects(const OcdFile< F >& file)
 	MapPart* part = map->getCurrentPart();
 	FILEFORMAT_ASSERT(part);
 	
+	std::vector<const typename F::Object*> ocd_objects;
 	for (auto ocd_object : file.objects())
 	{
 		if ( ocd_object.entry->symbol
 		     && ocd_object.entry->status != Ocd::ObjectDeleted
 		     && ocd_object.entry->status != Ocd::ObjectDeletedForUndo )
 		{
-			if (auto object = importObject(*ocd_object.entity, part))
-				part->addObject(object, part->getNumObjects());
+			ocd_objects.push_back(ocd_object.entity);
 		}
 	}
+	importObjects(ocd_objects, part);
 }
 
 
@@ -1921,6 +1928,53 @@ void setObjectDates(Object* object, const Ocd::ObjectV9& ocd_object)
 }
 
 
+template< class O >
+void OcdFileImport::importObjects(const std::vector<const O*>& ocd_objects, MapPart* part)
+{
+	// Create regular path objects on this thread, in order, because this may
+	// modify symbols and add warnings.
+	auto const num_objects = ocd_objects.size();
+	std::vector<std::unique_ptr<OcdImportedPathObject>> path_objects(num_objects);
+	for (std::size_t i = 0; i < num_objects; ++i)
+	{
+		auto const& ocd_object = *ocd_objects[i];
+		auto* symbol = ocd_object.symbol >= 0 ? symbol_index.value(static_cast<unsigned int>(ocd_object.symbol)) : nullptr;
+		if (symbol
+		    && (symbol->getType() == Symbol::Line || symbol->getType() == Symbol::Area || symbol->getType() == Symbol::Combined)
+		    && !(symbol->getType() == Symbol::Line && rectangle_info.contains(ocd_object.symbol)))
+		{
+			path_objects[i].reset(createPathObject(ocd_object, symbol));
+		}
+	}
+	
+	// Decode the coordinates concurrently, in chunks of objects.
+	processConcurrently(num_objects, objects_per_chunk, [&](std::size_t first, std::size_t last, std::size_t /*worker*/) {
+		for (auto i = first; i < last; ++i)
+		{
+			if (path_objects[i])
+				fillPathObject(path_objects[i].get(), *ocd_objects[i]);
+		}
+	});
+	
+	// Add all objects in file order.
+	for (std::size_t i = 0; i < num_objects; ++i)
+	{
+		Object* object;
+		if (path_objects[i])
+		{
+			object = path_objects[i].release();
+			object->setMap(map);
+		}
+		else
+		{
+			object = importObject(*ocd_objects[i], part);
+		}
+		if (object)
+			part->addObject(object, part->getNumObjects());
+	}
+}
+
+
 template< class O >
 Object* OcdFileImport::importObject(const O& ocd_object, MapPart* part)
 {
@@ -2014,33 +2068,46 @@ Object* OcdFileImport::importObject(const O& ocd_object, MapPart* part)
 	}
 	else if (symbol->getType() == Symbol::Line || symbol->getType() == Symbol::Area || symbol->getType() == Symbol::Combined)
 	{
-		auto p = new OcdImportedPathObject(symbol);
-		p->setPatternRotation(convertAngle(ocd_object.angle));
-		if (symbol->getType() == Symbol::Area)
-		{
-			auto* area_symbol = symbol->asArea();
-			
-			if (area_symbol->getNumFillPatterns()
-			    && !area_symbol->hasRotatableFillPattern()
-			    && ocd_object.angle)
-			{
-				for (auto n = 0; n < area_symbol->getNumFillPatterns(); ++n)
-					area_symbol->getFillPattern(n).setRotatable(true);
-				addSymbolWarning(area_symbol, tr("Removing rotation lock due to the existence of an area with a rotated pattern."));
-			}
-		}
-		
-		// Normal path
-		fillPathCoords(p, symbol->getContainedTypes() & Symbol::Area, ocd_object.num_items, reinterpret_cast<const Ocd::OcdPoint32 *>(ocd_object.coords));
-		p->recalculateParts();
+		auto p = createPathObject(ocd_object, symbol);
+		fillPathObject(p, ocd_object);
 		p->setMap(map);
-		setObjectDates(p, ocd_object);		
 		return p;
 	}
 	
 	return nullptr;
 }
 
+template< class O >
+OcdFileImport::OcdImportedPathObject* OcdFileImport::createPathObject(const O& ocd_object, Symbol* symbol)
+{
+	auto p = new OcdImportedPathObject(symbol);
+	p->setPatternRotation(convertAngle(ocd_object.angle));
+	if (symbol->getType() == Symbol::Area)
+	{
+		auto* area_symbol = symbol->asArea();
+		
+		if (area_symbol->getNumFillPatterns()
+		    && !area_symbol->hasRotatableFillPattern()
+		    && ocd_object.angle)
+		{
+			for (auto n = 0; n < area_symbol->getNumFillPatterns(); ++n)
+				area_symbol->getFillPattern(n).setRotatable(true);
+			addSymbolWarning(area_symbol, tr("Removing rotation lock due to the existence of an area with a rotated pattern."));
+		}
+	}
+	return p;
+}
+
+template< class O >
+void OcdFileImport::fillPathObject(OcdImportedPathObject* object, const O& ocd_object) const
+{
+	// Normal path
+	auto const is_area = bool(object->getSymbol()->getContainedTypes() & Symbol::Area);
+	fillPathCoords(object, is_area, ocd_object.num_items, reinterpret_cast<const Ocd::OcdPoint32 *>(ocd_object.coords));
+	object->recalculateParts();
+	setObjectDates(object, ocd_object);
+}
+
 
 namespace {
 // OCD v8 may choose between Unicode and custom text encoding
@@ -2212,7 +2279,7 @@ Object* OcdFileImport::importRectangleObject(const Ocd::OcdPoint32* ocd_points,
 	return border_path;
 }
 
-void OcdFileImport::setPathHolePoint(OcdImportedPathObject *object, quint32 pos)
+void OcdFileImport::setPathHolePoint(OcdImportedPathObject *object, quint32 pos) const
 {
 	// Look for curve start points before the current point and apply hole point only if no such point is there.
 	// This prevents hole points in the middle of a curve caused by incorrect map objects.
@@ -2226,7 +2293,7 @@ void OcdFileImport::setPathHolePoint(OcdImportedPathObject *object, quint32 pos)
 		object->coords[pos].setHolePoint(true);
 }
 
-void OcdFileImport::setPointFlags(OcdImportedPathObject* object, quint32 pos, bool is_area, const Ocd::OcdPoint32& ocd_point)
+void OcdFileImport::setPointFlags(OcdImportedPathObject* object, quint32 pos, bool is_area, const Ocd::OcdPoint32& ocd_point) const
 {
 	// We can support CurveStart, HolePoint, DashPoint.
 	// CurveStart needs to be applied to the main point though, not the control point, and
@@ -2241,7 +2308,7 @@ void OcdFileImport::setPointFlags(OcdImportedPathObject* object, quint32 pos, bo
 
 /** Translates the OC*D path given in the last two arguments into an Object.
  */
-void OcdFileImport::fillPathCoords(OcdImportedPathObject *object, bool is_area, quint32 num_points, const Ocd::OcdPoint32* ocd_points)
+void OcdFileImport::fillPathCoords(OcdImportedPathObject *object, bool is_area, quint32 num_points, const Ocd::OcdPoint32* ocd_points) const
 {
 	object->coords.resize(num_points);
 	for (auto i = 0u; i < num_points; i++)
@@ -2461,7 +2528,19 @@ void OcdFileImport::setFraming(OcdFileImport::OcdImportedTextSymbol* symbol, con
 
 bool OcdFileImport::importImplementation()
 {
-	buffer = device()->readAll();
+	// Files are mapped into memory if possible, so that only the parts
+	// which are actually visited by the import need to be paged in.
+	auto* const file = qobject_cast<QFileDevice*>(device());
+	auto* const mapping = (file && file->size() > 0) ? file->map(0, file->size()) : nullptr;
+	auto const release_buffer = qScopeGuard([this, file, mapping]() {
+		buffer.clear();
+		if (mapping)
+			file->unmap(mapping);
+	});
+	if (mapping)
+		buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(mapping), file->size());
+	else
+		buffer = device()->readAll();
 	if (buffer.isEmpty())
 		throw FileFormatException(device()->errorString());
 	
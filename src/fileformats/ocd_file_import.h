@@ -291,9 +291,30 @@ protected:
 	
 	// Object import
 	
+	/**
+	 * Imports the given objects and appends them to the part, in order.
+	 * 
+	 * The coordinates of regular path objects are decoded concurrently.
+	 * Everything which may modify symbols, the map or the warnings is done
+	 * on the calling thread.
+	 */
+	template< class O >
+	void importObjects(const std::vector<const O*>& ocd_objects, MapPart* part);
+	
 	template< class O >
 	Object* importObject(const O& ocd_object, MapPart* part);
 	
+	template< class O >
+	OcdImportedPathObject* createPathObject(const O& ocd_object, Symbol* symbol);
+	
+	/**
+	 * Sets the coordinates and dates of a path object created by createPathObject().
+	 * 
+	 * This function may be called concurrently for different objects.
+	 */
+	template< class O >
+	void fillPathObject(OcdImportedPathObject* object, const O& ocd_object) const;
+	
 	template< class O >
 	QString getObjectText(const O& ocd_object) const;
 	
@@ -304,11 +325,11 @@ protected:
 	
 	// Some helper functions that are used in multiple places
 	
-	void setPointFlags(OcdImportedPathObject* object, quint32 pos, bool is_area, const Ocd::OcdPoint32& ocd_point);
+	void setPointFlags(OcdImportedPathObject* object, quint32 pos, bool is_area, const Ocd::OcdPoint32& ocd_point) const;
 	
-	void setPathHolePoint(OcdFileImport::OcdImportedPathObject* object, quint32 pos);
+	void setPathHolePoint(OcdFileImport::OcdImportedPathObject* object, quint32 pos) const;
 	
-	void fillPathCoords(OcdFileImport::OcdImportedPathObject* object, bool is_area, quint32 num_points, const Ocd::OcdPoint32* ocd_points);
+	void fillPathCoords(OcdFileImport::OcdImportedPathObject* object, bool is_area, quint32 num_points, const Ocd::OcdPoint32* ocd_points) const;
 	
 	bool fillTextPathCoords(TextObject* object, TextSymbol* symbol, quint32 npts, const Ocd::OcdPoint32* ocd_points);
 	
@@ -322,6 +343,12 @@ protected:
 	/// The locale is used for number formatting.
 	QLocale locale;
 	
+	/**
+	 * The file data during import.
+	 * 
+	 * For regular files, this is a raw data view of a memory mapping which is
+	 * released at the end of the import. It must not be modified.
+	 */
 	QByteArray buffer;
 	
 	/// Character encoding to use for 1-byte (narrow) strings
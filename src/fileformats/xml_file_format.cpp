@@ -27,6 +27,7 @@
 #include <QLocale>
 #include <QObject>
 #include <QRectF>
+#include <QScopeGuard>
 #include <QScopedValueRollback>
 #include <QString>
 #include <QStringView>
@@ -49,6 +50,7 @@
 #include "fileformats/file_import_export.h"
 #include "templates/template.h"
 #include "undo/undo_manager.h"
+#include "util/gzip_device.h"
 #include "util/xml_stream_util.h"
 
 
@@ -72,27 +74,11 @@ QString mapperNamespace()
 }
 
 
-}  // namespace
-
-
-
-XMLFileFormat::XMLFileFormat()
- : FileFormat(MapFile,
-              "XML",
-              ::LibreMapper::ImportExport::tr("OpenOrienteering Mapper"),
-              QString::fromLatin1("omap"),
-              Feature::FileOpen | Feature::FileImport |
-              Feature::FileSave | Feature::FileSaveAs )
-{
-	addExtension(QString::fromLatin1("xmap"));
-}
-
-
-FileFormat::ImportSupportAssumption XMLFileFormat::understands(const char* buffer, int size) const
+FileFormat::ImportSupportAssumption understandsXml(const char* buffer, int size)
 {
 	const auto data = QByteArray::fromRawData(buffer, size);
 	if (size >= 4 && qstrncmp(buffer, "OMAP", 4) == 0)
-	    return FullySupported;  // Legacy binary format. Final error raised in doImport().
+	    return FileFormat::FullySupported;  // Legacy binary format. Final error raised in doImport().
 	
 	if (size > 38)  // length of "<?xml ...>"
 	{
@@ -100,28 +86,120 @@ FileFormat::ImportSupportAssumption XMLFileFormat::understands(const char* buffe
 		if (xml.readNextStartElement())
 		{
 			if (xml.name() != QLatin1String("map"))
-				return NotSupported;
+				return FileFormat::NotSupported;
 			if (xml.namespaceUri() == mapperNamespace())
-				return FullySupported;
+				return FileFormat::FullySupported;
 			if (xml.namespaceUri() == QLatin1String("http://oorienteering.sourceforge.net/mapper/xml/v2"))
-			    return FullySupported;
+			    return FileFormat::FullySupported;
 		}
 	}
 	auto trimmed = data.trimmed();
 	if (!trimmed.isEmpty() && !trimmed.startsWith('<'))
-		return NotSupported;
+		return FileFormat::NotSupported;
 		
-	return Unknown;
+	return FileFormat::Unknown;
+}
+
+
+
+/**
+ * Map exporter for gzip-compressed XML files.
+ * 
+ * The XML document is compressed while it is written.
+ */
+class CompressedXMLFileExporter : public XMLFileExporter
+{
+public:
+	using XMLFileExporter::XMLFileExporter;
+	
+protected:
+	bool exportImplementation() override;
+};
+
+bool CompressedXMLFileExporter::exportImplementation()
+{
+	auto* const target = device();
+	GzipCompressingDevice compressed(*target);
+	compressed.open(QIODevice::WriteOnly);
+	setDevice(&compressed);
+	auto const restore_device = qScopeGuard([this, target]() { setDevice(target); });
+	if (!XMLFileExporter::exportImplementation())
+		return false;
+	if (!compressed.finish())
+		throw FileFormatException(compressed.errorString());
+	return true;
+}
+
+
+
+/**
+ * Map importer for gzip-compressed XML files.
+ * 
+ * The XML document is decompressed while it is read.
+ */
+class CompressedXMLFileImporter : public XMLFileImporter
+{
+public:
+	using XMLFileImporter::XMLFileImporter;
+	
+protected:
+	bool importImplementation() override;
+};
+
+bool CompressedXMLFileImporter::importImplementation()
+{
+	auto* const source = device();
+	GzipDecompressingDevice decompressed(*source);
+	decompressed.open(QIODevice::ReadOnly);
+	setDevice(&decompressed);
+	auto const restore_device = qScopeGuard([this, source]() { setDevice(source); });
+	return XMLFileImporter::importImplementation();
+}
+
+
+}  // namespace
+
+
+
+XMLFileFormat::XMLFileFormat(Compression compression)
+ : FileFormat(MapFile,
+              compression == GzipCompressed ? "XML-gz" : "XML",
+              compression == GzipCompressed ? ::LibreMapper::ImportExport::tr("OpenOrienteering Mapper, compressed")
+                                            : ::LibreMapper::ImportExport::tr("OpenOrienteering Mapper"),
+              QString::fromLatin1(compression == GzipCompressed ? "omapz" : "omap"),
+              Feature::FileOpen | Feature::FileImport |
+              Feature::FileSave | Feature::FileSaveAs )
+ , compression(compression)
+{
+	if (compression == Uncompressed)
+		addExtension(QString::fromLatin1("xmap"));
+}
+
+
+FileFormat::ImportSupportAssumption XMLFileFormat::understands(const char* buffer, int size) const
+{
+	if (compression == GzipCompressed)
+	{
+		if (!GzipDecompressingDevice::hasSignature(buffer, size))
+			return NotSupported;
+		auto const data = GzipDecompressingDevice::decompressPrefix(buffer, size, 4096);
+		return understandsXml(data.constData(), int(data.size()));
+	}
+	return understandsXml(buffer, size);
 }
 
 
 std::unique_ptr<Importer> XMLFileFormat::makeImporter(const QString& path, Map* map, MapView* view) const
 {
+	if (compression == GzipCompressed)
+		return std::make_unique<CompressedXMLFileImporter>(path, map, view);
 	return std::make_unique<XMLFileImporter>(path, map, view);
 }
 
 std::unique_ptr<Exporter> XMLFileFormat::makeExporter(const QString& path, const Map* map, const MapView* view) const
 {
+	if (compression == GzipCompressed)
+		return std::make_unique<CompressedXMLFileExporter>(path, map, view);
 	return std::make_unique<XMLFileExporter>(path, map, view);
 }
 
@@ -30,12 +30,22 @@ class MapView;
 class XMLFileFormat : public FileFormat
 {
 public:
+	/** @brief The compression of the file.
+	 */
+	enum Compression
+	{
+		Uncompressed,   ///< Plain XML, *.omap, *.xmap
+		GzipCompressed  ///< gzip-compressed XML, *.omapz
+	};
+	
 	/** @brief Creates a new file format of type XML.
 	 */
-	XMLFileFormat();
+	explicit XMLFileFormat(Compression compression = Uncompressed);
 	
 	
 	/** @brief Returns true for an XML file using the Mapper namespace.
+	 * 
+	 * For the compressed variant, the start of the decompressed data is tested.
 	 */
 	ImportSupportAssumption understands(const char* buffer, int size) const override;
 	
@@ -63,6 +73,9 @@ public:
 	 */
 	static int active_version;
 	
+private:
+	Compression compression;
+	
 };
 
 
@@ -44,6 +44,7 @@ public:
 	// Template display options
 	const QString gdal_hatch_key{ QStringLiteral("area_hatching") };
 	const QString gdal_baseline_key{ QStringLiteral("baseline_view") };
+	const QString gdal_streaming_key{ QStringLiteral("template_streaming") };
 	
 	// Export options
 	const QString ogr_one_layer_per_symbol_key{ QStringLiteral("per_symbol_layer") };
@@ -440,6 +441,16 @@ void GdalManager::setBaselineViewEnabled(bool enabled)
 	p->setSettingsValue(p->gdal_baseline_key, enabled);
 }
 
+bool GdalManager::isTemplateStreamingEnabled() const
+{
+	return p->settingsValue(p->gdal_streaming_key, false).toBool();
+}
+
+void GdalManager::setTemplateStreamingEnabled(bool enabled)
+{
+	p->setSettingsValue(p->gdal_streaming_key, enabled);
+}
+
 
 void GdalManager::setFormatEnabled(GdalManager::FileFormat format, bool enabled)
 {
@@ -84,6 +84,20 @@ public:
 	void setBaselineViewEnabled(bool enabled);
 	
 	
+	/**
+	 * Returns the template streaming setting.
+	 * 
+	 * When enabled, vector data templates load only the features near the
+	 * currently displayed area.
+	 */
+	bool isTemplateStreamingEnabled() const;
+	
+	/**
+	 * Sets the template streaming setting.
+	 */
+	void setTemplateStreamingEnabled(bool enabled);
+	
+	
 	/**
 	 * Enables or disables handling of a particular file format by GDAL.
 	 */
@@ -57,6 +57,10 @@ GdalSettingsPage::GdalSettingsPage(QWidget* parent)
 	view_baseline = new QCheckBox(tr("Baseline view"));
 	form_layout->addRow(view_baseline);
 	
+	view_streaming = new QCheckBox(tr("Load only the displayed area"));
+	view_streaming->setToolTip(tr("Reduces the memory used by large vector data templates"));
+	form_layout->addRow(view_streaming);
+	
 	
 	form_layout->addItem(Util::SpacerItem::create(this));
 	form_layout->addRow(Util::Headline::create(tr("Export Options")));
@@ -101,6 +105,7 @@ void GdalSettingsPage::apply()
 	manager.setFormatEnabled(GdalManager::GPX, import_gpx->isChecked());
 	manager.setAreaHatchingEnabled(view_hatch->isChecked());
 	manager.setBaselineViewEnabled(view_baseline->isChecked());
+	manager.setTemplateStreamingEnabled(view_streaming->isChecked());
 	
 	// The file format constructor establishes the extensions.
 	auto format = new OgrFileImportFormat();
@@ -147,6 +152,7 @@ void GdalSettingsPage::updateWidgets()
 	import_gpx->setChecked(manager.isFormatEnabled(GdalManager::GPX));
 	view_hatch->setChecked(manager.isAreaHatchingEnabled());
 	view_baseline->setChecked(manager.isBaselineViewEnabled());
+	view_streaming->setChecked(manager.isTemplateStreamingEnabled());
 	
 	export_one_layer_per_symbol->setChecked(manager.isExportOptionEnabled(GdalManager::OneLayerPerSymbol));
 	
@@ -46,6 +46,7 @@ private:
 	QCheckBox* import_gpx;
 	QCheckBox* view_hatch;
 	QCheckBox* view_baseline;
+	QCheckBox* view_streaming;
 	QCheckBox* export_one_layer_per_symbol;
 	QTableWidget* parameters;
 };
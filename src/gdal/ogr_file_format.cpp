@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <exception>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -19,6 +20,7 @@
 #include <vector>
 
 #include <cpl_conv.h>
+#include <cpl_string.h>
 #include <gdal.h>
 #include <ogr_api.h>
 #include <ogr_srs_api.h>
@@ -69,7 +71,9 @@
 #include "gdal/gdal_manager.h"
 #include "gdal/gdal_template.h"
 #include "templates/template.h"
+#include "util/concurrency.h"
 #include "util/key_value_container.h"
+#include "util/util.h"
 
 // IWYU pragma: no_forward_declare QFile
 
@@ -594,6 +598,89 @@ namespace {
 	};
 	
 	
+	/// The number of features which are read and converted at once.
+	constexpr std::size_t features_per_batch = 1024;
+	
+	/// The number of features which a thread takes at once when creating objects.
+	constexpr std::size_t features_per_chunk = 64;
+	
+	/// The number of objects which a thread takes at once when building geometries.
+	constexpr std::size_t objects_per_chunk = 256;
+	
+	/// The number of features written in a single transaction.
+	constexpr std::size_t features_per_transaction = 100000;
+	
+	
+	/**
+	 * Calls the function for each point or simple curve in the given geometry.
+	 */
+	template <class Function>
+	void forEachSimpleGeometry(OGRGeometryH geometry, Function&& function)
+	{
+		auto const num_geometries = OGR_G_GetGeometryCount(geometry);
+		if (num_geometries == 0)
+		{
+			auto const type = wkbFlatten(OGR_G_GetGeometryType(geometry));
+			if (type == wkbPoint || (OGR_GT_IsCurve(type) && type != wkbCompoundCurve))
+				function(geometry);
+		}
+		for (int i = 0; i < num_geometries; ++i)
+			forEachSimpleGeometry(OGR_G_GetGeometryRef(geometry, i), function);
+	}
+	
+	/**
+	 * Appends the points of the geometry to the given coordinate arrays.
+	 */
+	void collectPoints(OGRGeometryH geometry, std::vector<double>& x, std::vector<double>& y, std::vector<double>& z)
+	{
+		forEachSimpleGeometry(geometry, [&x, &y, &z](OGRGeometryH simple) {
+			auto const offset = x.size();
+			auto const count = std::size_t(OGR_G_GetPointCount(simple));
+			x.resize(offset + count);
+			y.resize(offset + count);
+			z.resize(offset + count);
+			OGR_G_GetPoints(simple,
+			                x.data() + offset, sizeof(double),
+			                y.data() + offset, sizeof(double),
+			                z.data() + offset, sizeof(double));
+		});
+	}
+	
+	/**
+	 * Replaces the points of the geometry with the given coordinates.
+	 * 
+	 * This is the inverse of collectPoints(). It returns the number of points
+	 * taken from the arrays.
+	 */
+	std::size_t storePoints(OGRGeometryH geometry, const double* x, const double* y, const double* z)
+	{
+		std::size_t offset = 0;
+		forEachSimpleGeometry(geometry, [&offset, x, y, z](OGRGeometryH simple) {
+			auto const count = OGR_G_GetPointCount(simple);
+			OGR_G_SetPoints(simple, count,
+			                x + offset, sizeof(double),
+			                y + offset, sizeof(double),
+			                OGR_G_Is3D(simple) ? z + offset : nullptr, sizeof(double));
+			offset += std::size_t(count);
+		});
+		return offset;
+	}
+	
+	/**
+	 * Returns the value as a single-quoted SQL string literal.
+	 * 
+	 * Embedded quotes are doubled.
+	 */
+	QByteArray sqlStringLiteral(const char* value)
+	{
+		auto literal = QByteArray(value);
+		literal.replace('\'', "''");
+		literal.prepend('\'');
+		literal.append('\'');
+		return literal;
+	}
+	
+	
 }  // namespace
 
 
@@ -745,6 +832,41 @@ OgrFileImport::OgrFileImport(const QString& path, Map* map, MapView* view, UnitT
 OgrFileImport::~OgrFileImport() = default;  // not inlined
 
 
+/**
+ * The state of a single feature during import.
+ * 
+ * Symbols are looked up on the importing thread. Counters are collected
+ * here while the objects are created on worker threads.
+ */
+struct OgrFileImport::FeatureImport
+{
+	FeatureImport() = default;
+	FeatureImport(const FeatureImport&) = delete;
+	FeatureImport(FeatureImport&&) = default;
+	FeatureImport& operator=(const FeatureImport&) = delete;
+	FeatureImport& operator=(FeatureImport&&) = default;
+	
+	~FeatureImport()
+	{
+		for (auto* object : objects)
+			delete object;
+	}
+	
+	ogr::unique_feature feature;
+	OGRGeometryH geometry = nullptr;
+	MapCoordConstructor to_map_coord = nullptr;
+	Symbol* point_symbol = nullptr;
+	Symbol* line_symbol = nullptr;
+	Symbol* area_symbol = nullptr;
+	ObjectList objects;
+	KeyValueContainer tags;
+	std::exception_ptr error;
+	bool clipped = false;
+	int unsupported_geometry_type = 0;
+	int too_few_coordinates = 0;
+};
+
+
 
 bool OgrFileImport::supportsQIODevice() const noexcept
 {
@@ -758,6 +880,16 @@ void OgrFileImport::setGeoreferencingImportEnabled(bool enabled)
 	georeferencing_import_enabled = enabled;
 }
 
+void OgrFileImport::setSpatialFilter(const QRectF& area)
+{
+	spatial_filter = area;
+}
+
+void OgrFileImport::setDataExtentEnabled(bool enabled)
+{
+	data_extent_enabled = enabled;
+}
+
 
 
 ogr::unique_srs OgrFileImport::srsFromMap()
@@ -821,6 +953,10 @@ bool OgrFileImport::importImplementation()
 		map_srs = srsFromMap();
 	
 	importStyles(data_source.get());
+	
+	data_extent = {};
+	if (data_extent_enabled)
+		data_extent = calculateDataExtent(data_source.get());
 
 	if (!loadSymbolsOnly())
 	{
@@ -1035,7 +1171,16 @@ void OgrFileImport::importLayer(MapPart* map_part, OGRLayerH layer)
 		clipping = getLayerClipping(layer);
 	}
 	
+	if (spatial_filter.isValid())
+	{
+		// OGR takes a copy of the filter geometry.
+		auto filter = getLayerSpatialFilter(layer);
+		OGR_L_SetSpatialFilter(layer, filter.get());
+	}
+	
 	OGR_L_ResetReading(layer);
+	std::vector<FeatureImport> batch;
+	batch.reserve(features_per_batch);
 	while (auto feature = ogr::unique_feature(OGR_L_GetNextFeature(layer)))
 	{
 		auto geometry = OGR_F_GetGeometryRef(feature.get());
@@ -1045,48 +1190,174 @@ void OgrFileImport::importLayer(MapPart* map_part, OGRLayerH layer)
 			continue;
 		}
 		
-		importFeature(map_part, feature_definition, feature.get(), geometry, clipping.get());
+		batch.emplace_back();
+		batch.back().feature = std::move(feature);
+		batch.back().geometry = geometry;
+		if (batch.size() == features_per_batch)
+		{
+			importFeatures(map_part, feature_definition, batch, clipping.get());
+			batch.clear();
+		}
 	}
+	importFeatures(map_part, feature_definition, batch, clipping.get());
+	
+	if (spatial_filter.isValid())
+		OGR_L_SetSpatialFilter(layer, nullptr);
 }
 
-void OgrFileImport::importFeature(MapPart* map_part, OGRFeatureDefnH feature_definition, OGRFeatureH feature, OGRGeometryH geometry, const Clipping* clipping)
+void OgrFileImport::importFeatures(MapPart* map_part, OGRFeatureDefnH feature_definition, std::vector<FeatureImport>& features, const Clipping* clipping)
 {
-	auto new_srs = OGR_G_GetSpatialReference(geometry);
-	if (!setSRS(new_srs))
-		return;
-	
-	if (new_srs)
+	// Transform the coordinates, in as few calls as possible.
+	std::vector<FeatureImport*> pending;
+	for (auto& feature : features)
 	{
-		auto error = OGR_G_Transform(geometry, data_transform.get());
-		if (error)
+		auto new_srs = OGR_G_GetSpatialReference(feature.geometry);
+		if (new_srs && new_srs != data_srs)
 		{
-			++failed_transformation;
-			return;
+			// setSRS() is going to replace the current transformation.
+			transformGeometries(pending);
+			pending.clear();
+		}
+		if (!setSRS(new_srs))
+		{
+			feature.geometry = nullptr;
+			continue;
 		}
+		
+		feature.to_map_coord = to_map_coord;
+		if (new_srs)
+			pending.push_back(&feature);
 	}
+	transformGeometries(pending);
 	
-	auto objects = importGeometry(feature, geometry);
-	auto const tags = importFields(feature_definition, feature);
+	// Look up the symbols on this thread, in the order of the features,
+	// because new symbols are added to the map.
+	for (auto& feature : features)
+	{
+		if (feature.geometry)
+			resolveSymbols(feature, feature.geometry);
+	}
 	
-	if (driverName() == "LIBKML")
+	// Create the objects concurrently.
+	// KML overlay icons must be handled before clipping, on this thread.
+	// Text objects share font data with their symbol, so they are also
+	// updated and clipped on this thread.
+	auto const kml = driverName() == "LIBKML";
+	auto const is_text = [](const Object* object) { return object->getType() == Object::Text; };
+	processConcurrently(features.size(), features_per_chunk, [&](std::size_t first, std::size_t last, std::size_t /*worker*/) {
+		for (auto i = first; i < last; ++i)
+		{
+			auto& feature = features[i];
+			if (!feature.geometry)
+				continue;
+			try
+			{
+				feature.objects = importGeometry(feature, feature.geometry);
+				feature.tags = importFields(feature_definition, feature.feature.get());
+				if (clipping && !kml && std::none_of(begin(feature.objects), end(feature.objects), is_text))
+				{
+					auto const objects = std::move(feature.objects);
+					feature.objects = clipping->process(objects);
+					feature.clipped = true;
+				}
+			}
+			catch (...)
+			{
+				feature.error = std::current_exception();
+			}
+		}
+	});
+	
+	// Add all objects in the order of the features.
+	for (auto& feature : features)
 	{
-		handleKmlOverlayIcon(objects, tags);
+		if (feature.error)
+			std::rethrow_exception(feature.error);
+		
+		unsupported_geometry_type += feature.unsupported_geometry_type;
+		too_few_coordinates += feature.too_few_coordinates;
+		
+		if (kml)
+			handleKmlOverlayIcon(feature.objects, feature.tags);
+		if (clipping && !feature.clipped)
+		{
+			auto const objects = std::move(feature.objects);
+			feature.objects = clipping->process(objects);
+		}
+		
+		for (auto* object : feature.objects)
+		{
+			object->setTags(feature.tags);
+			map_part->addObject(object);
+		}
+		feature.objects.clear();
 	}
+}
+
+void OgrFileImport::transformGeometries(const std::vector<FeatureImport*>& features)
+{
+	if (features.empty())
+		return;
 	
-	if (clipping)
+	std::vector<double> x, y, z;
+	for (auto* feature : features)
+		collectPoints(feature->geometry, x, y, z);
+	if (OCTTransform(data_transform.get(), int(x.size()), x.data(), y.data(), z.data()))
 	{
-		auto clipped_objects = clipping->process(objects);
-		objects = std::move(clipped_objects);
+		std::size_t offset = 0;
+		for (auto* feature : features)
+			offset += storePoints(feature->geometry, x.data() + offset, y.data() + offset, z.data() + offset);
+		return;
 	}
 	
-	for (auto* object : objects)
+	// Some points cannot be transformed. Transform each geometry on its own,
+	// in order to skip only the affected features.
+	for (auto* feature : features)
+	{
+		if (OGR_G_Transform(feature->geometry, data_transform.get()) != OGRERR_NONE)
+		{
+			++failed_transformation;
+			feature->geometry = nullptr;
+		}
+	}
+}
+
+void OgrFileImport::resolveSymbols(FeatureImport& feature, OGRGeometryH geometry)
+{
+	// This must match the conditions in the import*Geometry() functions.
+	auto style = OGR_F_GetStyleString(feature.feature.get());
+	switch (wkbFlatten(OGR_G_GetGeometryType(geometry)))
 	{
-		object->setTags(tags);
-		map_part->addObject(object);
+	case OGRwkbGeometryType::wkbPoint:
+		if (!feature.point_symbol)
+			feature.point_symbol = getSymbol(Symbol::Point, style);
+		break;
+		
+	case OGRwkbGeometryType::wkbLineString:
+		if (!feature.line_symbol && OGR_G_GetPointCount(geometry) >= 2)
+			feature.line_symbol = getSymbol(Symbol::Line, style);
+		break;
+		
+	case OGRwkbGeometryType::wkbPolygon:
+		if (!feature.area_symbol && OGR_G_GetGeometryCount(geometry) >= 1
+		    && OGR_G_GetPointCount(OGR_G_GetGeometryRef(geometry, 0)) >= 3)
+			feature.area_symbol = getSymbol(Symbol::Area, style);
+		break;
+		
+	case OGRwkbGeometryType::wkbGeometryCollection:
+	case OGRwkbGeometryType::wkbMultiLineString:
+	case OGRwkbGeometryType::wkbMultiPoint:
+	case OGRwkbGeometryType::wkbMultiPolygon:
+		for (int i = 0; i < OGR_G_GetGeometryCount(geometry); ++i)
+			resolveSymbols(feature, OGR_G_GetGeometryRef(geometry, i));
+		break;
+		
+	default:
+		;  // unsupported type, will be reported in importGeometry
 	}
 }
 
-KeyValueContainer OgrFileImport::importFields(OGRFeatureDefnH feature_definition, OGRFeatureH feature)
+KeyValueContainer OgrFileImport::importFields(OGRFeatureDefnH feature_definition, OGRFeatureH feature) const
 {
 	KeyValueContainer tags;
 	auto const num_fields = feature_definition ? OGR_FD_GetFieldCount(feature_definition) : 0;
@@ -1102,7 +1373,7 @@ KeyValueContainer OgrFileImport::importFields(OGRFeatureDefnH feature_definition
 	return tags;
 }
 
-OgrFileImport::ObjectList OgrFileImport::importGeometry(OGRFeatureH feature, OGRGeometryH geometry)
+OgrFileImport::ObjectList OgrFileImport::importGeometry(FeatureImport& feature, OGRGeometryH geometry) const
 {
 	ObjectList result;
 	auto geometry_type = wkbFlatten(OGR_G_GetGeometryType(geometry));
@@ -1132,12 +1403,12 @@ OgrFileImport::ObjectList OgrFileImport::importGeometry(OGRFeatureH feature, OGR
 		
 	default:
 		qDebug("OgrFileImport: Unknown or unsupported geometry type: %d", geometry_type);
-		++unsupported_geometry_type;
+		++feature.unsupported_geometry_type;
 	}
 	return result;
 }
 
-OgrFileImport::ObjectList OgrFileImport::importGeometryCollection(OGRFeatureH feature, OGRGeometryH geometry)
+OgrFileImport::ObjectList OgrFileImport::importGeometryCollection(FeatureImport& feature, OGRGeometryH geometry) const
 {
 	ObjectList result;
 	auto num_geometries = OGR_G_GetGeometryCount(geometry);
@@ -1150,14 +1421,14 @@ OgrFileImport::ObjectList OgrFileImport::importGeometryCollection(OGRFeatureH fe
 	return result;
 }
 
-Object* OgrFileImport::importPointGeometry(OGRFeatureH feature, OGRGeometryH geometry)
+Object* OgrFileImport::importPointGeometry(FeatureImport& feature, OGRGeometryH geometry) const
 {
-	auto style = OGR_F_GetStyleString(feature);
-	auto symbol = getSymbol(Symbol::Point, style);
+	auto symbol = feature.point_symbol;
+	FILEFORMAT_ASSERT(symbol);
 	if (symbol->getType() == Symbol::Point)
 	{
 		auto object = new PointObject(symbol);
-		object->setPosition(toMapCoord(OGR_G_GetX(geometry, 0), OGR_G_GetY(geometry, 0)));
+		object->setPosition(toMapCoord(feature, OGR_G_GetX(geometry, 0), OGR_G_GetY(geometry, 0)));
 		return object;
 	}
 	
@@ -1174,16 +1445,16 @@ Object* OgrFileImport::importPointGeometry(OGRFeatureH feature, OGRGeometryH geo
 		{
 			label.remove(0, 1);
 			label.chop(1);
-			int index = OGR_F_GetFieldIndex(feature, label.toLatin1().constData());
+			int index = OGR_F_GetFieldIndex(feature.feature.get(), label.toLatin1().constData());
 			if (index >= 0)
 			{
-				label = QString::fromUtf8(OGR_F_GetFieldAsString(feature, index));
+				label = QString::fromUtf8(OGR_F_GetFieldAsString(feature.feature.get(), index));
 			}
 		}
 		if (!label.isEmpty())
 		{
 			auto object = new TextObject(symbol);
-			object->setAnchorPosition(toMapCoord(OGR_G_GetX(geometry, 0), OGR_G_GetY(geometry, 0)));
+			object->setAnchorPosition(toMapCoord(feature, OGR_G_GetX(geometry, 0), OGR_G_GetY(geometry, 0)));
 			// DXF observation
 			label.replace(QRegularExpression(QString::fromLatin1("(\\\\[^;]*;)*"), QRegularExpression::MultilineOption), QString{});
 			label.replace(QLatin1String("^I"), QLatin1String("\t"));
@@ -1209,7 +1480,7 @@ Object* OgrFileImport::importPointGeometry(OGRFeatureH feature, OGRGeometryH geo
 	return nullptr;
 }
 
-PathObject* OgrFileImport::importLineStringGeometry(OGRFeatureH feature, OGRGeometryH geometry)
+PathObject* OgrFileImport::importLineStringGeometry(FeatureImport& feature, OGRGeometryH geometry) const
 {
 	auto managed_geometry = ogr::unique_geometry(nullptr);
 	if (OGR_G_GetGeometryType(geometry) != wkbLineString)
@@ -1221,25 +1492,25 @@ PathObject* OgrFileImport::importLineStringGeometry(OGRFeatureH feature, OGRGeom
 	auto num_points = OGR_G_GetPointCount(geometry);
 	if (num_points < 2)
 	{
-		++too_few_coordinates;
+		++feature.too_few_coordinates;
 		return nullptr;
 	}
 	
-	auto style = OGR_F_GetStyleString(feature);
-	auto object = new PathObject(getSymbol(Symbol::Line, style));
+	FILEFORMAT_ASSERT(feature.line_symbol);
+	auto object = new PathObject(feature.line_symbol);
 	for (int i = 0; i < num_points; ++i)
 	{
-		object->addCoordinate(toMapCoord(OGR_G_GetX(geometry, i), OGR_G_GetY(geometry, i)));
+		object->addCoordinate(toMapCoord(feature, OGR_G_GetX(geometry, i), OGR_G_GetY(geometry, i)));
 	}
 	return object;
 }
 
-PathObject* OgrFileImport::importPolygonGeometry(OGRFeatureH feature, OGRGeometryH geometry)
+PathObject* OgrFileImport::importPolygonGeometry(FeatureImport& feature, OGRGeometryH geometry) const
 {
 	auto num_geometries = OGR_G_GetGeometryCount(geometry);
 	if (num_geometries < 1)
 	{
-		++too_few_coordinates;
+		++feature.too_few_coordinates;
 		return nullptr;
 	}
 	
@@ -1253,15 +1524,15 @@ PathObject* OgrFileImport::importPolygonGeometry(OGRFeatureH feature, OGRGeometr
 	auto num_points = OGR_G_GetPointCount(outline);
 	if (num_points < 3)
 	{
-		++too_few_coordinates;
+		++feature.too_few_coordinates;
 		return nullptr;
 	}
 	
-	auto style = OGR_F_GetStyleString(feature);
-	auto object = new PathObject(getSymbol(Symbol::Area, style));
+	FILEFORMAT_ASSERT(feature.area_symbol);
+	auto object = new PathObject(feature.area_symbol);
 	for (int i = 0; i < num_points; ++i)
 	{
-		object->addCoordinate(toMapCoord(OGR_G_GetX(outline, i), OGR_G_GetY(outline, i)));
+		object->addCoordinate(toMapCoord(feature, OGR_G_GetX(outline, i), OGR_G_GetY(outline, i)));
 	}
 	
 	for (int g = 1; g < num_geometries; ++g)
@@ -1271,7 +1542,7 @@ PathObject* OgrFileImport::importPolygonGeometry(OGRFeatureH feature, OGRGeometr
 		auto num_points = OGR_G_GetPointCount(hole);
 		for (int i = 0; i < num_points; ++i)
 		{
-			object->addCoordinate(toMapCoord(OGR_G_GetX(hole, i), OGR_G_GetY(hole, i)), start_new_part);
+			object->addCoordinate(toMapCoord(feature, OGR_G_GetX(hole, i), OGR_G_GetY(hole, i)), start_new_part);
 			start_new_part = false;
 		}
 	}
@@ -1318,6 +1589,97 @@ std::unique_ptr<OgrFileImport::Clipping> OgrFileImport::getLayerClipping(OGRLaye
 }
 
 
+ogr::unique_geometry OgrFileImport::getLayerSpatialFilter(OGRLayerH layer)
+{
+	auto const layer_srs = OGR_L_GetSpatialRef(layer);
+	auto const& georef = map->getGeoreferencing();
+	
+	auto outline = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLinearRing));
+	for (auto const& corner : { spatial_filter.topLeft(), spatial_filter.topRight(),
+	                            spatial_filter.bottomRight(), spatial_filter.bottomLeft() })
+	{
+		// Inverse of fromProjected() or fromDrawing(), cf. setSRS()
+		auto const point = (layer_srs || unit_type == UnitOnGround)
+		                   ? georef.toProjectedCoords(MapCoordF{corner})
+		                   : QPointF{corner.x(), -corner.y()};
+		OGR_G_AddPoint_2D(outline.get(), point.x(), point.y());
+	}
+	OGR_G_CloseRings(outline.get());
+	
+	if (layer_srs)
+	{
+		auto transformation = ogr::unique_transformation{ OCTNewCoordinateTransformation(map_srs.get(), layer_srs) };
+		if (!transformation)
+			return {};  // No filter
+		
+		// Densify the outline so that it remains a good approximation
+		// in the layer's spatial reference system.
+		OGREnvelope envelope;
+		OGR_G_GetEnvelope(outline.get(), &envelope);
+		OGR_G_Segmentize(outline.get(), std::max(envelope.MaxX - envelope.MinX, envelope.MaxY - envelope.MinY) / 16);
+		if (OGR_G_Transform(outline.get(), transformation.get()) != OGRERR_NONE)
+			return {};  // No filter
+	}
+	
+	auto polygon = ogr::unique_geometry(OGR_G_CreateGeometry(wkbPolygon));
+	OGR_G_AddGeometryDirectly(polygon.get(), outline.release());
+	return polygon;
+}
+
+
+QRectF OgrFileImport::calculateDataExtent(OGRDataSourceH data_source)
+{
+	QRectF extent;
+	auto num_layers = OGR_DS_GetLayerCount(data_source);
+	for (int i = 0; i < num_layers; ++i)
+	{
+		auto layer = OGR_DS_GetLayer(data_source, i);
+		if (!layer || qstrcmp(OGR_L_GetName(layer), "track_points") == 0)
+			continue;
+		
+		OGREnvelope envelope;
+		if (OGR_L_GetExtent(layer, &envelope, true) != OGRERR_NONE)
+		{
+			if (OGR_L_GetFeatureCount(layer, true) == 0)
+				continue;
+			return {};
+		}
+		
+		auto outline = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLinearRing));
+		OGR_G_AddPoint_2D(outline.get(), envelope.MinX, envelope.MinY);
+		OGR_G_AddPoint_2D(outline.get(), envelope.MaxX, envelope.MinY);
+		OGR_G_AddPoint_2D(outline.get(), envelope.MaxX, envelope.MaxY);
+		OGR_G_AddPoint_2D(outline.get(), envelope.MinX, envelope.MaxY);
+		OGR_G_CloseRings(outline.get());
+		
+		auto layer_srs = OGR_L_GetSpatialRef(layer);
+		if (!setSRS(layer_srs))
+			return {};
+		if (layer_srs)
+		{
+			// Densify the outline, cf. getLayerSpatialFilter()
+			auto const max_length = std::max(envelope.MaxX - envelope.MinX, envelope.MaxY - envelope.MinY) / 16;
+			if (max_length > 0)
+				OGR_G_Segmentize(outline.get(), max_length);
+			if (OGR_G_Transform(outline.get(), data_transform.get()) != OGRERR_NONE)
+				return {};
+		}
+		
+		// Like fromProjected() or fromDrawing(), but without MapCoord bounds
+		auto const& georef = map->getGeoreferencing();
+		for (int j = 0; j < OGR_G_GetPointCount(outline.get()); ++j)
+		{
+			auto const point = QPointF{ OGR_G_GetX(outline.get(), j), OGR_G_GetY(outline.get(), j) };
+			if (to_map_coord == &OgrFileImport::fromDrawing)
+				rectIncludeSafe(extent, QPointF{ point.x(), -point.y() });
+			else
+				rectIncludeSafe(extent, georef.toMapCoordF(point));
+		}
+	}
+	return extent;
+}
+
+
 bool OgrFileImport::setSRS(OGRSpatialReferenceH srs)
 {
 	to_map_coord = &OgrFileImport::fromProjected;
@@ -1742,6 +2104,11 @@ AreaSymbol* OgrFileImport::getSymbolForBrush(OGRStyleToolH tool, const QByteArra
 }
 
 
+MapCoord OgrFileImport::toMapCoord(const FeatureImport& feature, double x, double y) const
+{
+	return (this->*feature.to_map_coord)(x, y);
+}
+
 MapCoord OgrFileImport::fromDrawing(double x, double y) const
 {
 	return MapCoord::load(x, -y, MapCoord::Flags{});
@@ -2049,6 +2416,9 @@ bool OgrFileExport::exportImplementation()
 		}
 	}
 	
+	commitTransaction();
+	createSpatialIndexes();
+	
 	return true;
 }
 
@@ -2135,6 +2505,7 @@ void OgrFileExport::setupQuirks(GDALDriverH po_driver)
 	    { "DWG",           GeorefOptional },
 	    { "DXF",           OgrQuirks() | GeorefOptional | SingleLayer | UseLayerField },
 	    { "GeoJSON",       SingleLayer },
+	    { "GPKG",          DeferSpatialIndex },
 	    { "Geomedia",      GeorefOptional },
 	    { "GPX",           NeedsWgs84 },
 	    { "INGRES",        GeorefOptional },
@@ -2160,66 +2531,51 @@ void OgrFileExport::addPointsToLayer(OGRLayerH layer, const std::function<bool (
 {
 	const auto& georef = map->getGeoreferencing();
 
-	auto add_feature = [&](const Object* object) {
-		auto symbol = object->getSymbol();
-		auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
-
-		QString sym_name = symbol->getPlainTextName();
-		sym_name.truncate(32);
-		OGR_F_SetFieldString(po_feature.get(), OGR_F_GetFieldIndex(po_feature.get(), symbol_field), sym_name.toLatin1().constData());
-
+	auto make_geometries = [&georef](const Object* object) {
 		auto pt = ogr::unique_geometry(OGR_G_CreateGeometry(wkbPoint));
 		QPointF proj_cord = georef.toProjectedCoords(object->asPoint()->getCoordF());
 
 		OGR_G_SetPoint_2D(pt.get(), 0, proj_cord.x(), proj_cord.y());
 
-		if (quirks & NeedsWgs84)
-			OGR_G_Transform(pt.get(), transformation.get());
-
-		OGR_F_SetGeometry(po_feature.get(), pt.get());
-
-		OGR_F_SetStyleString(po_feature.get(), OGR_STBL_Find(table.get(), symbolId(symbol)));
+		GeometryList result;
+		result.push_back(std::move(pt));
+		return result;
+	};
 
-		if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-			throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+	auto setup_feature = [this](OGRFeatureH po_feature, const Object* object) {
+		OGR_F_SetStyleString(po_feature, OGR_STBL_Find(table.get(), symbolId(object->getSymbol())));
 	};
 
-	map->applyOnMatchingObjects(add_feature, condition);
+	addFeaturesToLayer(layer, condition, make_geometries, setup_feature);
 }
 
 void OgrFileExport::addTextToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition)
 {
 	const auto& georef = map->getGeoreferencing();
 
-	auto add_feature = [&](const Object* object) {
-		auto symbol = object->getSymbol();
-		auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
+	auto make_geometries = [&georef](const Object* object) {
+		auto pt = ogr::unique_geometry(OGR_G_CreateGeometry(wkbPoint));
+		QPointF proj_cord = georef.toProjectedCoords(object->asText()->getAnchorCoordF());
 
-		QString sym_name = symbol->getPlainTextName();
-		sym_name.truncate(32);
-		OGR_F_SetFieldString(po_feature.get(), OGR_F_GetFieldIndex(po_feature.get(), symbol_field), sym_name.toLatin1().constData());
+		OGR_G_SetPoint_2D(pt.get(), 0, proj_cord.x(), proj_cord.y());
 
+		GeometryList result;
+		result.push_back(std::move(pt));
+		return result;
+	};
+
+	auto setup_feature = [this](OGRFeatureH po_feature, const Object* object) {
 		auto text = object->asText()->getText();
 		if (o_name_field)
 		{
 			// Use the name field for the text (useful e.g. for KML).
 			// This may overwrite the symbol name, and
 			// it may be too short for the full text.
-			auto index = OGR_F_GetFieldIndex(po_feature.get(), OGR_Fld_GetNameRef(o_name_field.get()));
-			OGR_F_SetFieldString(po_feature.get(), index, QStringView{text}.left(32).toUtf8().constData());
+			auto index = OGR_F_GetFieldIndex(po_feature, OGR_Fld_GetNameRef(o_name_field.get()));
+			OGR_F_SetFieldString(po_feature, index, QStringView{text}.left(32).toUtf8().constData());
 		}
 
-		auto pt = ogr::unique_geometry(OGR_G_CreateGeometry(wkbPoint));
-		QPointF proj_cord = georef.toProjectedCoords(object->asText()->getAnchorCoordF());
-
-		OGR_G_SetPoint_2D(pt.get(), 0, proj_cord.x(), proj_cord.y());
-
-		if (quirks & NeedsWgs84)
-			OGR_G_Transform(pt.get(), transformation.get());
-
-		OGR_F_SetGeometry(po_feature.get(), pt.get());
-
-		QByteArray style = OGR_STBL_Find(table.get(), symbolId(symbol));
+		QByteArray style = OGR_STBL_Find(table.get(), symbolId(object->getSymbol()));
 		if (!o_name_field || text.length() > 32)
 		{
 			// There is no label field, or the text is too long.
@@ -2227,109 +2583,190 @@ void OgrFileExport::addTextToLayer(OGRLayerH layer, const std::function<bool (co
 			text.replace(QRegularExpression(QLatin1String("([\"\\\\])"), QRegularExpression::MultilineOption), QLatin1String("\\\\1"));
 			style.replace("{Name}", text.toUtf8());
 		}
-		OGR_F_SetStyleString(po_feature.get(), style);
-
-		if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-			throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+		OGR_F_SetStyleString(po_feature, style);
 	};
 
-	map->applyOnMatchingObjects(add_feature, condition);
+	addFeaturesToLayer(layer, condition, make_geometries, setup_feature);
 }
 
 void OgrFileExport::addLinesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition)
 {
 	const auto& georef = map->getGeoreferencing();
 
-	auto add_feature = [&](const Object* object) {
-		const auto* symbol = object->getSymbol();
-		const auto* path = object->asPath();
-		if (path->parts().empty())
-			return;
-
-		QString sym_name = symbol->getPlainTextName();
-		sym_name.truncate(32);
-
-		auto line_string = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLineString));
-		const auto& parts = path->parts();
+	// One feature per path part
+	auto make_geometries = [&georef](const Object* object) {
+		GeometryList result;
+		const auto& parts = object->asPath()->parts();
+		result.reserve(parts.size());
 		for (const auto& part : parts)
 		{
-			auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
-			OGR_F_SetFieldString(po_feature.get(), OGR_F_GetFieldIndex(po_feature.get(), symbol_field), sym_name.toLatin1().constData());
-
+			auto line_string = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLineString));
+			OGR_G_SetPointCount(line_string.get(), int(part.path_coords.size()));
+			int i = 0;
 			for (const auto& coord : part.path_coords)
 			{
 				QPointF proj_cord = georef.toProjectedCoords(coord.pos);
-				OGR_G_AddPoint_2D(line_string.get(), proj_cord.x(), proj_cord.y());
+				OGR_G_SetPoint_2D(line_string.get(), i++, proj_cord.x(), proj_cord.y());
 			}
-
-			if (quirks & NeedsWgs84)
-				OGR_G_Transform(line_string.get(), transformation.get());
-
-			OGR_F_SetGeometry(po_feature.get(), line_string.get());
-
-			OGR_F_SetStyleString(po_feature.get(), OGR_STBL_Find(table.get(), symbolId(symbol)));
-
-			if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-				throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+			result.push_back(std::move(line_string));
 		}
+		return result;
+	};
+
+	auto setup_feature = [this](OGRFeatureH po_feature, const Object* object) {
+		OGR_F_SetStyleString(po_feature, OGR_STBL_Find(table.get(), symbolId(object->getSymbol())));
 	};
 
-	map->applyOnMatchingObjects(add_feature, condition);
+	addFeaturesToLayer(layer, condition, make_geometries, setup_feature);
 }
 
 void OgrFileExport::addAreasToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition)
 {
 	const auto& georef = map->getGeoreferencing();
 
-	auto add_feature = [&](const Object* object) {
-		const auto* symbol = object->getSymbol();
-		const auto* path = object->asPath();
-		if (path->parts().empty())
-			return;
-
-		auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
-
-		QString sym_name = symbol->getPlainTextName();
-		sym_name.truncate(32);
-		OGR_F_SetFieldString(po_feature.get(), OGR_F_GetFieldIndex(po_feature.get(), symbol_field), sym_name.toLatin1().constData());
+	auto make_geometries = [&georef](const Object* object) {
+		GeometryList result;
+		const auto& parts = object->asPath()->parts();
+		if (parts.empty())
+			return result;
 
 		auto polygon = ogr::unique_geometry(OGR_G_CreateGeometry(wkbPolygon));
-		auto cur_ring = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLinearRing));
-
-		const auto& parts = path->parts();
 		for (const auto& part : parts)
 		{
+			auto cur_ring = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLinearRing));
+			OGR_G_SetPointCount(cur_ring.get(), int(part.path_coords.size()));
+			int i = 0;
 			for (const auto& coord : part.path_coords)
 			{
 				QPointF proj_cord = georef.toProjectedCoords(coord.pos);
-				OGR_G_AddPoint_2D(cur_ring.get(), proj_cord.x(), proj_cord.y());
+				OGR_G_SetPoint_2D(cur_ring.get(), i++, proj_cord.x(), proj_cord.y());
 			}
 			OGR_G_CloseRings(cur_ring.get());
-			if (quirks & NeedsWgs84)
-				OGR_G_Transform(cur_ring.get(), transformation.get());
-			OGR_G_AddGeometry(polygon.get(), cur_ring.get());
-			cur_ring.reset(OGR_G_CreateGeometry(wkbLinearRing));
+			OGR_G_AddGeometryDirectly(polygon.get(), cur_ring.release());
 		}
+		result.push_back(std::move(polygon));
+		return result;
+	};
 
-		OGR_F_SetGeometry(po_feature.get(), polygon.get());
+	auto setup_feature = [this](OGRFeatureH po_feature, const Object* object) {
+		OGR_F_SetStyleString(po_feature, OGR_STBL_Find(table.get(), symbolId(object->getSymbol())));
+	};
 
-		OGR_F_SetStyleString(po_feature.get(), OGR_STBL_Find(table.get(), symbolId(symbol)));
+	addFeaturesToLayer(layer, condition, make_geometries, setup_feature);
+}
 
-		if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-			throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
-	};
+void OgrFileExport::addFeaturesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition,
+                                       const GeometryBuilder& make_geometries, const FeatureSetup& setup_feature)
+{
+	std::vector<const Object*> objects;
+	map->applyOnMatchingObjects([&objects](const Object* object) { objects.push_back(object); }, condition);
+	
+	// Build the geometries concurrently.
+	// Each thread needs its own coordinate transformation.
+	std::vector<GeometryList> geometries(objects.size());
+	std::vector<ogr::unique_transformation> thread_transformations(concurrentWorkers(objects.size(), objects_per_chunk));
+	processConcurrently(objects.size(), objects_per_chunk, [&](std::size_t first, std::size_t last, std::size_t worker) {
+		auto& thread_transformation = thread_transformations[worker];
+		if (!thread_transformation && (quirks & NeedsWgs84) && transformation)
+			thread_transformation.reset(OCTClone(transformation.get()));
+		for (auto i = first; i < last; ++i)
+		{
+			geometries[i] = make_geometries(objects[i]);
+			if (thread_transformation)
+			{
+				for (auto& geometry : geometries[i])
+					OGR_G_Transform(geometry.get(), thread_transformation.get());
+			}
+		}
+	});
+	
+	// Write the features in order, in large transactions.
+	if (layer != transaction_layer)
+	{
+		commitTransaction();
+		startTransaction(layer);
+	}
+	for (std::size_t i = 0; i < objects.size(); ++i)
+	{
+		QString sym_name = objects[i]->getSymbol()->getPlainTextName();
+		sym_name.truncate(32);
+		auto const sym_name_latin1 = sym_name.toLatin1();
+		
+		for (auto& geometry : geometries[i])
+		{
+			auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
+			OGR_F_SetFieldString(po_feature.get(), OGR_F_GetFieldIndex(po_feature.get(), symbol_field), sym_name_latin1.constData());
+			setup_feature(po_feature.get(), objects[i]);
+			OGR_F_SetGeometryDirectly(po_feature.get(), geometry.release());
+			
+			if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
+				throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+			
+			if (transaction_layer && ++transaction_size >= features_per_transaction)
+			{
+				commitTransaction();
+				startTransaction(layer);
+			}
+		}
+		geometries[i].clear();
+	}
+}
 
-	map->applyOnMatchingObjects(add_feature, condition);
+void OgrFileExport::startTransaction(OGRLayerH layer)
+{
+	if (OGR_L_TestCapability(layer, OLCTransactions)
+	    && OGR_L_StartTransaction(layer) == OGRERR_NONE)
+	{
+		transaction_layer = layer;
+		transaction_size = 0;
+	}
+}
+
+void OgrFileExport::commitTransaction()
+{
+	if (!transaction_layer)
+		return;
+	
+	auto* const layer = transaction_layer;
+	transaction_layer = nullptr;
+	if (OGR_L_CommitTransaction(layer) != OGRERR_NONE)
+		throw FileFormatException(tr("Failed to commit features to layer %1: %2").arg(QString::fromUtf8(OGR_L_GetName(layer)), QString::fromLatin1(CPLGetLastErrorMsg())));
+}
+
+void OgrFileExport::createSpatialIndexes()
+{
+	for (auto* layer : deferred_index_layers)
+	{
+		QByteArray const sql = "SELECT CreateSpatialIndex("
+		                       + sqlStringLiteral(OGR_L_GetName(layer)) + ", "
+		                       + sqlStringLiteral(OGR_L_GetGeometryColumn(layer)) + ')';
+		auto result = GDALDatasetExecuteSQL(po_ds.get(), sql.constData(), nullptr, nullptr);
+		if (result)
+			GDALDatasetReleaseResultSet(po_ds.get(), result);
+		else
+			addWarning(tr("Failed to create spatial index: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+	}
+	deferred_index_layers.clear();
 }
 
 OGRLayerH OgrFileExport::createLayer(const char* layer_name, OGRwkbGeometryType type)
 {
-	auto po_layer = GDALDatasetCreateLayer(po_ds.get(), layer_name, map_srs.get(), type, nullptr);
+	// Some drivers cannot create layers while a transaction is active.
+	commitTransaction();
+	
+	char** options = nullptr;
+	if (quirks.testFlag(DeferSpatialIndex))
+		options = CSLSetNameValue(options, "SPATIAL_INDEX", "NO");
+	auto po_layer = GDALDatasetCreateLayer(po_ds.get(), layer_name, map_srs.get(), type, options);
+	CSLDestroy(options);
 	if (!po_layer) {
 		addWarning(tr("Failed to create layer %1: %2").arg(QString::fromUtf8(layer_name), QString::fromLatin1(CPLGetLastErrorMsg())));
 		return nullptr;
 	}
 
+	if (quirks.testFlag(DeferSpatialIndex))
+		deferred_index_layers.push_back(po_layer);
+
 	if (!quirks.testFlag(UseLayerField)
 	    && OGR_L_CreateField(po_layer, o_name_field.get(), 1) != OGRERR_NONE)
 	{
@@ -8,6 +8,7 @@
 #ifndef LIBREMAPPER_OGR_FILE_FORMAT_P_H
 #define LIBREMAPPER_OGR_FILE_FORMAT_P_H
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -17,6 +18,7 @@
 #include <QCoreApplication>
 #include <QFlags>
 #include <QHash>
+#include <QRectF>
 #include <QString>
 #include <QtGlobal>
 
@@ -244,6 +246,35 @@ public:
 	 */
 	void setGeoreferencingImportEnabled(bool enabled);
 	
+	/**
+	 * Restricts the import to features intersecting the given area.
+	 * 
+	 * The area is given in map coordinates of the Map given to the
+	 * constructor, i.e. relative to its current georeferencing. It is
+	 * transformed to each layer's spatial reference system and passed to
+	 * OGR, so that drivers with a spatial index read only nearby features.
+	 * 
+	 * An invalid rectangle (the default) disables the filter.
+	 */
+	void setSpatialFilter(const QRectF& area);
+	
+	/**
+	 * Enables the calculation of the extent of the data in all layers.
+	 * 
+	 * The extent is requested from the layers, independent of the spatial
+	 * filter and of loadSymbolsOnly(). Some drivers need to read all
+	 * features to determine the extent.
+	 */
+	void setDataExtentEnabled(bool enabled);
+	
+	/**
+	 * Returns the extent of the data in all layers, in map coordinates.
+	 * 
+	 * The rectangle is invalid if the calculation was not enabled, or if
+	 * the extent of a non-empty layer could not be determined.
+	 */
+	QRectF dataExtent() const { return data_extent; }
+	
 	
 	/**
 	 * Tests if the file's spatial references can be used with the given georeferencing.
@@ -285,23 +316,48 @@ protected:
 	
 	void importLayer(MapPart* map_part, OGRLayerH layer);
 	
-	void importFeature(MapPart* map_part, OGRFeatureDefnH feature_definition, OGRFeatureH feature, OGRGeometryH geometry, const Clipping* clipping);
+	struct FeatureImport;
+	
+	/**
+	 * Imports a batch of features.
+	 * 
+	 * The coordinates of all features are transformed together, and the
+	 * objects are created concurrently. They are added to the map part in
+	 * the order of the features.
+	 */
+	void importFeatures(MapPart* map_part, OGRFeatureDefnH feature_definition, std::vector<FeatureImport>& features, const Clipping* clipping);
 	
+	/**
+	 * Transforms the geometries of the features with the current data transformation.
+	 * 
+	 * The geometry of features which cannot be transformed is reset to nullptr.
+	 */
+	void transformGeometries(const std::vector<FeatureImport*>& features);
+	
+	/**
+	 * Looks up the symbols needed for the geometry of the feature.
+	 */
+	void resolveSymbols(FeatureImport& feature, OGRGeometryH geometry);
 	
-	KeyValueContainer importFields(OGRFeatureDefnH feature_definition, OGRFeatureH feature);
+	
+	KeyValueContainer importFields(OGRFeatureDefnH feature_definition, OGRFeatureH feature) const;
 		
-	ObjectList importGeometry(OGRFeatureH feature, OGRGeometryH geometry);
+	ObjectList importGeometry(FeatureImport& feature, OGRGeometryH geometry) const;
 	
-	ObjectList importGeometryCollection(OGRFeatureH feature, OGRGeometryH geometry);
+	ObjectList importGeometryCollection(FeatureImport& feature, OGRGeometryH geometry) const;
 	
-	Object* importPointGeometry(OGRFeatureH feature, OGRGeometryH geometry);
+	Object* importPointGeometry(FeatureImport& feature, OGRGeometryH geometry) const;
 	
-	PathObject* importLineStringGeometry(OGRFeatureH feature, OGRGeometryH geometry);
+	PathObject* importLineStringGeometry(FeatureImport& feature, OGRGeometryH geometry) const;
 	
-	PathObject* importPolygonGeometry(OGRFeatureH feature, OGRGeometryH geometry);
+	PathObject* importPolygonGeometry(FeatureImport& feature, OGRGeometryH geometry) const;
 	
 	std::unique_ptr<Clipping> getLayerClipping(OGRLayerH layer);
 	
+	ogr::unique_geometry getLayerSpatialFilter(OGRLayerH layer);
+	
+	QRectF calculateDataExtent(OGRDataSourceH data_source);
+	
 	
 	bool setSRS(OGRSpatialReferenceH srs);
 	
@@ -317,6 +373,11 @@ protected:
 	
 	MapCoord toMapCoord(double x, double y) const;
 	
+	/**
+	 * Creates a MapCoord, using the coordinate constructor for the feature.
+	 */
+	MapCoord toMapCoord(const FeatureImport& feature, double x, double y) const;
+	
 	/**
 	 * A MapCoordConstructor which interprets the given coordinates in millimeters on paper.
 	 */
@@ -375,9 +436,13 @@ private:
 	int unsupported_geometry_type = 0;
 	int too_few_coordinates = 0;
 	
+	QRectF spatial_filter;
+	QRectF data_extent;
+	
 	UnitType unit_type;
 	
 	bool georeferencing_import_enabled = true;
+	bool data_extent_enabled = false;
 	bool clip_layers;
 };
 
@@ -414,6 +479,7 @@ public:
 		NeedsWgs84     = 0x02,   ///< The driver needs WGS84 geographic coordinates.
 		SingleLayer    = 0x04,   ///< The driver supports just a single layer.
 		UseLayerField  = 0x08,   ///< Write the symbol names to the layer field.
+		DeferSpatialIndex = 0x10,   ///< Create the spatial index after writing the features.
 	};
 
 	/**
@@ -436,6 +502,35 @@ protected:
 	void addLinesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition);
 	void addAreasToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition);
 
+	using GeometryList = std::vector<ogr::unique_geometry>;
+	using GeometryBuilder = std::function<GeometryList (const Object*)>;
+	using FeatureSetup = std::function<void (OGRFeatureH, const Object*)>;
+
+	/**
+	 * Writes a feature for each geometry of the matching objects.
+	 * 
+	 * The geometries are built concurrently, and transformed if needed.
+	 * The features are written in the order of the objects, by the calling
+	 * thread, which also calls setup_feature for each feature.
+	 */
+	void addFeaturesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition,
+	                        const GeometryBuilder& make_geometries, const FeatureSetup& setup_feature);
+
+	/**
+	 * Starts a transaction for the layer, if the driver supports transactions.
+	 */
+	void startTransaction(OGRLayerH layer);
+
+	/**
+	 * Commits the current transaction, if any.
+	 */
+	void commitTransaction();
+
+	/**
+	 * Creates the spatial indexes which were deferred by DeferSpatialIndex.
+	 */
+	void createSpatialIndexes();
+
 	OGRLayerH createLayer(const char* layer_name, OGRwkbGeometryType type);
 
 	static QByteArray symbolId(const Symbol* symbol) { return QByteArray::number(quint64(symbol), 16); }
@@ -455,6 +550,10 @@ private:
 	
 	const char* symbol_field;
 
+	OGRLayerH transaction_layer = nullptr;
+	std::size_t transaction_size = 0;
+	std::vector<OGRLayerH> deferred_index_layers;
+
 	OgrQuirks quirks;
 };
 
@@ -23,6 +23,7 @@
 #include <QPointF>
 #include <QRectF>
 #include <QStringRef>
+#include <QTimer>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -41,6 +42,7 @@
 #include "templates/template.h"
 #include "templates/template_positioning_dialog.h"
 #include "templates/template_track.h"
+#include "util/util.h"
 
 
 namespace LibreMapper {
@@ -55,6 +57,15 @@ namespace {
 	}
 	
 	
+	/**
+	 * The maximum size of the streaming window, relative to the data extent.
+	 * 
+	 * Windows covering a larger part of the data are not worth the repeated
+	 * reloading when panning. All data is loaded instead.
+	 */
+	constexpr qreal max_streaming_window_fraction = 0.5;
+	
+	
 	bool preserveRefPoints(Georeferencing& data_georef, const Georeferencing& initial_georef)
 	{
 		// Keep a configured local reference point from initial_georef?
@@ -365,6 +376,33 @@ try
 		new_template_map->setGeoreferencing(*explicit_georef);
 	}
 	
+	streaming = GdalManager().isTemplateStreamingEnabled();
+	if (!streaming)
+	{
+		streaming_window = {};
+		data_extent = {};
+		streaming_complete = false;
+	}
+	else if (!streaming_complete)
+	{
+		if (streaming_window.isValid())
+		{
+			QRectF area;
+			auto const& georef = new_template_map->getGeoreferencing();
+			rectIncludeSafe(area, QPointF(georef.toMapCoordF(streaming_window.topLeft())));
+			rectIncludeSafe(area, QPointF(georef.toMapCoordF(streaming_window.topRight())));
+			rectIncludeSafe(area, QPointF(georef.toMapCoordF(streaming_window.bottomRight())));
+			rectIncludeSafe(area, QPointF(georef.toMapCoordF(streaming_window.bottomLeft())));
+			importer.setSpatialFilter(area);
+		}
+		else
+		{
+			// The features will be loaded when the template is drawn.
+			importer.setLoadSymbolsOnly(true);
+			importer.setDataExtentEnabled(true);
+		}
+	}
+	
 	const auto pp0 = new_template_map->getGeoreferencing().getProjectedRefPoint();
 	importer.setGeoreferencingImportEnabled(false);
 	if (!importer.doImport())
@@ -373,6 +411,15 @@ try
 		return false;
 	}
 	
+	auto const data_map_extent = importer.dataExtent();
+	if (data_map_extent.isValid())
+	{
+		auto const& georef = new_template_map->getGeoreferencing();
+		data_extent = {};
+		for (auto const& corner : { data_map_extent.topLeft(), data_map_extent.topRight(), data_map_extent.bottomRight(), data_map_extent.bottomLeft() })
+			rectIncludeSafe(data_extent, georef.toProjectedCoords(MapCoordF{corner}));
+	}
+	
 	// MapCoord bounds handling may have moved the paper position of the
 	// template data during import. The template position might need to be
 	// adjusted accordingly.
@@ -411,7 +458,8 @@ catch (FileFormatException& e)
 bool OgrTemplate::postLoadSetup(QWidget* dialog_parent, bool& out_center_in_view)
 {
 	Q_UNUSED(dialog_parent)
-	out_center_in_view = center_in_view;
+	// In streaming mode, the extent of the data may be unknown.
+	out_center_in_view = center_in_view && (!streaming || streaming_complete || data_extent.isValid());
 	return true;
 }
 
@@ -488,11 +536,15 @@ void OgrTemplate::mapTransformationChanged()
 
 void OgrTemplate::drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const
 {
+	if (streaming && on_screen)
+		requestStreamingArea(clip_rect);
+	
 	// For efficiency, re-implementing Map::drawTemplates
 	auto const draw_child_templates = [this, painter, &clip_rect, scale, on_screen, opacity](int first, int  last)  {
 		for (int i = first; i < last; ++i)
 		{
 			auto const* temp = templateMap()->getTemplate(i);
+			temp->recordUsage();
 			if (temp->getTemplateState() != Template::Loaded)
 				continue;
 			if (!clip_rect.intersects(temp->calculateTemplateBoundingBox()))
@@ -509,8 +561,20 @@ void OgrTemplate::drawTemplate(QPainter* painter, const QRectF& clip_rect, doubl
 
 QRectF OgrTemplate::getTemplateExtent() const
 {
-	// If the template is invalid, the extent is an empty rectangle.
+	// In streaming mode, the loaded data may not represent the full extent.
 	QRectF extent;
+	if (streaming && !streaming_complete && templateMap())
+	{
+		if (!data_extent.isValid())
+			return infiniteRectF();
+		
+		auto const& georef = templateMap()->getGeoreferencing();
+		for (auto const& corner : { data_extent.topLeft(), data_extent.topRight(), data_extent.bottomRight(), data_extent.bottomLeft() })
+			rectIncludeSafe(extent, QPointF(georef.toMapCoordF(corner)));
+		return extent;
+	}
+	
+	// If the template is invalid, the extent is an empty rectangle.
 	if (templateMap())
 		extent = templateMap()->calculateExtent(false, true, nullptr);
 	return extent;
@@ -521,7 +585,11 @@ QRectF OgrTemplate::getTemplateExtent() const
 void OgrTemplate::applySettings()
 {
 	if (auto* template_map = templateMap())
+	{
 		updateView(*template_map);
+		if (streaming != GdalManager().isTemplateStreamingEnabled())
+			reloadLater();
+	}
 }
 
 void OgrTemplate::updateView(Map& template_map)
@@ -545,12 +613,60 @@ void OgrTemplate::updateView(Map& template_map)
 	if (dirty && templateMap() == &template_map)
 	{
 		template_map.updateAllObjects();
+		invalidateRasterCache();
 		setTemplateAreaDirty();
 	}
 }
 
 
 
+void OgrTemplate::requestStreamingArea(const QRectF& map_rect) const
+{
+	if (template_state != Loaded || streaming_pending || streaming_complete)
+		return;
+	
+	QRectF area;
+	auto const& georef = templateMap()->getGeoreferencing();
+	for (auto const& corner : { map_rect.topLeft(), map_rect.topRight(), map_rect.bottomRight(), map_rect.bottomLeft() })
+	{
+		auto const template_coords = is_georeferenced ? MapCoordF{corner} : mapToTemplate(MapCoordF{corner});
+		rectIncludeSafe(area, georef.toProjectedCoords(template_coords));
+	}
+	if (data_extent.isValid())
+		area = area.intersected(data_extent);
+	if (area.isEmpty() || streaming_window.contains(area))
+		return;
+	
+	streaming_pending = true;
+	QTimer::singleShot(0, this, [this, area]() {
+		const_cast<OgrTemplate*>(this)->loadStreamingArea(area);
+	});
+}
+
+void OgrTemplate::loadStreamingArea(const QRectF& projected_area)
+{
+	streaming_pending = false;
+	if (template_state != Loaded || !streaming)
+		return;
+	
+	auto const margin = std::max(projected_area.width(), projected_area.height()) / 2;
+	auto const window = projected_area.adjusted(-margin, -margin, margin, margin);
+	auto const covered = window.intersected(data_extent);
+	if (!data_extent.isValid()
+	    || covered.width() * covered.height() >= max_streaming_window_fraction * data_extent.width() * data_extent.height())
+	{
+		streaming_window = {};
+		streaming_complete = true;
+	}
+	else
+	{
+		streaming_window = window;
+	}
+	reload();
+}
+
+
+
 bool OgrTemplate::loadTypeSpecificTemplateConfiguration(QXmlStreamReader& xml)
 {
 	if (xml.name() == literal::georeferencing)
@@ -13,6 +13,7 @@
 
 #include <QtGlobal>
 #include <QObject>
+#include <QRectF>
 #include <QString>
 
 #include "templates/template.h"
@@ -20,7 +21,6 @@
 
 class QByteArray;
 class QPainter;
-class QRectF;
 class QWidget;
 class QXmlStreamReader;
 class QXmlStreamWriter;
@@ -112,6 +112,28 @@ public:
 protected:
 	void updateView(Map& template_map);
 	
+	/**
+	 * Schedules the loading of the data for the given area, in streaming mode.
+	 * 
+	 * The area is given in map coordinates. Nothing is scheduled if the area
+	 * is already covered by the loaded data, or if it is outside of the
+	 * data extent.
+	 */
+	void requestStreamingArea(const QRectF& map_rect) const;
+	
+	/**
+	 * Reloads the template data for the given area, in streaming mode.
+	 * 
+	 * The area is given in projected coordinates. A margin is added so that
+	 * moderate panning does not cause another reload. Data outside of the
+	 * extended area is discarded.
+	 * 
+	 * If the extended area covers a large part of the data extent, or if the
+	 * data extent is unknown, all data is loaded and streaming stops until
+	 * the streaming setting changes.
+	 */
+	void loadStreamingArea(const QRectF& projected_area);
+	
 	void mapTransformationChanged() override;
 	
 	bool loadTypeSpecificTemplateConfiguration(QXmlStreamReader& xml) override;
@@ -124,10 +146,15 @@ private:
 	std::unique_ptr<Georeferencing> map_configuration_georef;
 	QString track_crs_spec;           // (limited) TemplateTrack compatibility
 	QString projected_crs_spec;       // (limited) TemplateTrack compatibility
+	QRectF streaming_window;          //  transient, projected coordinates
+	QRectF data_extent;               //  transient, projected coordinates
 	bool template_track_compatibility { false };  //  transient
 	bool explicit_georef_pending      { false };  //  transient
 	bool use_real_coords              { true };   //  transient
 	bool center_in_view               { false };  //  transient
+	bool streaming                    { false };  //  transient
+	bool streaming_complete           { false };  //  transient
+	mutable bool streaming_pending    { false };  //  transient
 };
 
 
@@ -24,6 +24,7 @@ void doStaticInitializations()
 {
 	// Register the supported file formats
 	FileFormats.registerFormat(new XMLFileFormat());
+	FileFormats.registerFormat(new XMLFileFormat(XMLFileFormat::GzipCompressed));
 #ifndef MAPPER_BIG_ENDIAN
 	for (auto&& format : OcdFileFormat::makeAll())
 		FileFormats.registerFormat(format.release());
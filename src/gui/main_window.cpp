@@ -36,6 +36,7 @@
 
 #include "mapper_config.h"
 #include "settings.h"
+#include "core/autosave_journal.h"
 #include "core/map.h"
 #include "core/map_view.h"
 #include "core/symbols/symbol.h"
@@ -301,6 +302,7 @@ void MainWindow::setController(MainWindowController* new_controller, bool has_fi
 	menuBar()->setVisible(new_controller->menuBarVisible());
 	statusBar()->setVisible(new_controller->statusBarVisible());
 	controller->attach(this);
+	connect(controller, &MainWindowController::fileSaved, this, &MainWindow::fileSaved);
 	
 	if (create_menu)
 		createHelpMenu();
@@ -634,6 +636,10 @@ bool MainWindow::event(QEvent* event)
 
 void MainWindow::closeEvent(QCloseEvent* event)
 {
+	// A failed background save marks the map as modified again.
+	if (controller)
+		controller->finishSaving();
+	
 	if (!has_opened_file)
 	{
 		saveWindowSettings();
@@ -720,7 +726,7 @@ bool MainWindow::showSaveOnCloseDialog()
 			break;
 			
 		case QMessageBox::Save:
-			if (!save())
+			if (!save() || !controller->finishSaving())
 				return false;
 			Q_FALLTHROUGH(); 
 			
@@ -1101,7 +1107,8 @@ bool MainWindow::removeAutosaveFile() const
 	if (!currentPath().isEmpty() && !has_autosave_conflict)
 	{
 		QFile autosave_file(autosavePath(currentPath()));
-		return !autosave_file.exists() || autosave_file.remove();
+		return AutosaveJournal::remove(autosave_file.fileName())
+		       && (!autosave_file.exists() || autosave_file.remove());
 	}
 	return false;
 }
@@ -1121,7 +1128,7 @@ Autosave::AutosaveResult MainWindow::autosave()
 	else
 	{
 		showStatusBarMessageImmediately(tr("Autosaving..."), 0);
-		if (controller->exportTo(autosavePath(currentPath()), *autosave_format))
+		if (controller->autosaveTo(autosavePath(currentPath()), *autosave_format))
 		{
 			// Success
 			clearStatusBarMessage();
@@ -1171,23 +1178,27 @@ bool MainWindow::saveTo(const QString &path, const FileFormat& format)
 			return showSaveAsDialog();
 	}
 	
+	// The window state is updated by fileSaved().
 	if (!controller->saveTo(path, format))
 		return false;
 	
 	setMostRecentlyUsedFile(path);
 	
+	return true;
+}
+
+void MainWindow::fileSaved(const QString& path, const FileFormat* format)
+{
 	setHasAutosaveConflict(false);
-	removeAutosaveFile();
+	if (!has_unsaved_changes)
+		removeAutosaveFile();
 	
 	if (path != currentPath())
 	{
-		setCurrentFile(path, &format);
-		removeAutosaveFile();
+		setCurrentFile(path, format);
+		if (!has_unsaved_changes)
+			removeAutosaveFile();
 	}
-	
-	setHasUnsavedChanges(false);
-	
-	return true;
 }
 
 // static
@@ -436,6 +436,14 @@ protected slots:
 	 */
 	void settingsChanged();
 	
+	/**
+	 * Updates the current file and the autosave state after saving.
+	 * 
+	 * The autosave file is kept if the map was modified while the file was
+	 * written in the background.
+	 */
+	void fileSaved(const QString& path, const LibreMapper::FileFormat* format);
+	
 private:
 	/**
 	 * Enables or disables the "toast" which replaces the status bar in touch mode.
@@ -71,6 +71,16 @@ bool MainWindowController::exportTo(const QString& /*path*/, const FileFormat& /
 	return false;
 }
 
+bool MainWindowController::autosaveTo(const QString& path, const FileFormat& format)
+{
+	return exportTo(path, format);
+}
+
+bool MainWindowController::finishSaving()
+{
+	return true;
+}
+
 bool MainWindowController::loadFrom(const QString& /*path*/, const FileFormat& /*format*/, QWidget* /*dialog_parent*/)
 {
 	return false;
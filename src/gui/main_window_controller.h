@@ -52,6 +52,7 @@ public:
 	
 	
 	/** Save to a file.
+	 *  Implementations may continue writing in the background, see finishSaving().
 	 *  @param path the path to save to
 	 *  @param format the file format
 	 *  @return true if saving was successful, false on errors
@@ -72,6 +73,26 @@ public:
 	 *  @return true if saving was successful, false on errors
 	 */
 	virtual bool exportTo(const QString& path, const FileFormat& format);
+	
+	/** Autosave to a file, but don't change modified state
+	 *  with regard to the original file.
+	 *  The default implementation calls exportTo().
+	 *  @param path the path to autosave to
+	 *  @param format the file format
+	 *  @return true if saving was successful, false on errors
+	 */
+	virtual bool autosaveTo(const QString& path, const FileFormat& format);
+	
+	/**
+	 * Waits for a save operation which is still writing in the background.
+	 * 
+	 * On success, fileSaved() is emitted. Errors are reported to the user.
+	 * 
+	 * The default implementation does nothing and returns true.
+	 * 
+	 * @return false if a pending save operation failed, true otherwise
+	 */
+	virtual bool finishSaving();
 
 	/** Load from a file.
 	 *  @param path the path to load from
@@ -133,6 +154,15 @@ public:
 	 */
 	static MainWindowController* controllerForFile(const QString& filename);
 	
+signals:
+	/**
+	 * This signal is emitted when saveTo() completed writing the file.
+	 * 
+	 * For saving in the background, this happens when the file was
+	 * successfully written to disk, which may be after saveTo() returned.
+	 */
+	void fileSaved(const QString& path, const LibreMapper::FileFormat* format);
+	
 protected:
 	MainWindow* window;
 };
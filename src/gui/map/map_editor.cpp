@@ -66,6 +66,7 @@
 #include <QPushButton>
 #include <QRect>
 #include <QRectF>
+#include <QSaveFile>
 #include <QSettings>
 #include <QSignalBlocker>
 #include <QSignalMapper>
@@ -86,11 +87,13 @@
 #endif
 
 #include "settings.h"
+#include "core/autosave_journal.h"
 #include "core/georeferencing.h"
 #include "core/map.h"
 #include "core/map_coord.h"
 #include "core/map_part.h"
 #include "core/map_view.h"
+#include "core/storage_location.h"  // IWYU pragma: keep
 #include "core/objects/boolean_tool.h"
 #include "core/objects/object.h"
 #include "core/objects/object_operations.h"
@@ -221,6 +224,16 @@ namespace {
 		});
 	}
 	
+	bool hasOpenParts(const Object* object)
+	{
+		if (object->getType() != Object::Path)
+			return false;
+		auto const& parts = object->asPath()->parts();
+		return std::any_of(begin(parts), end(parts), [](const auto& part) {
+			return !part.isClosed();
+		});
+	}
+	
 	
 }  // namespace
 
@@ -299,6 +312,11 @@ MapEditorController::MapEditorController(OperatingMode mode, Map* map, MapView*
 
 MapEditorController::~MapEditorController()
 {
+	// No dialogs during destruction.
+	if (joinSaveThread() && !save_error.isEmpty())
+		qWarning("Cannot save file %s: %s", qPrintable(save_path), qPrintable(save_error));
+	autosave_journal.reset();
+	
 	paste_act = nullptr;
 	delete current_tool;
 	delete override_tool;
@@ -581,12 +599,36 @@ bool MapEditorController::saveTo(const QString& path, const FileFormat& format)
 		return false;
 	}
 	
-	if (!exportTo(path, format))
+	finishSaving();
+	
+	auto exporter = makeExporter(path, format);
+	if (!exporter)
+		return false;
+	
+	// The map is serialized to memory on this thread, because map objects
+	// are not thread-safe, and the GUI is blocked while doing so. Only
+	// writing to disk, including the final sync, runs in the background.
+	// Exporters which cannot write to a QIODevice create the file on their own.
+	QBuffer snapshot;
+	if (exporter->supportsQIODevice())
+	{
+		snapshot.open(QIODevice::WriteOnly);
+		exporter->setDevice(&snapshot);
+	}
+	if (!runExporter(*exporter, path))
 		return false;
 	
+	if (snapshot.isOpen())
+	{
+		snapshot.close();
+		writeInBackground(path, format, snapshot.data());
+		return true;
+	}
+	
 	map->setHasUnsavedChanges(false);
 	map->undoManager().setClean();
 	window->showStatusBarMessage(tr("Map saved"), 1000);
+	emit fileSaved(path, &format);
 	return true;
 }
 
@@ -596,6 +638,71 @@ bool MapEditorController::exportTo(const QString& path, const FileFormat& format
 	if (!map || editing_in_progress)
 		return false;
 	
+	auto exporter = makeExporter(path, format);
+	return exporter && runExporter(*exporter, path);
+}
+
+
+bool MapEditorController::autosaveTo(const QString& path, const FileFormat& format)
+{
+	if (!map || editing_in_progress)
+		return false;
+	
+	if (!autosave_journal || autosave_journal->checkpointPath() != path)
+		autosave_journal = std::make_unique<AutosaveJournal>(*map, path);
+	
+	if (!autosave_journal->needsCheckpoint() && autosave_journal->append())
+		return true;
+	
+	return exportTo(path, format) && autosave_journal->checkpointWritten();
+}
+
+
+bool MapEditorController::finishSaving()
+{
+	if (!joinSaveThread())
+		return true;
+	
+	if (!save_error.isEmpty())
+	{
+		// The map is still marked as modified.
+		window->clearStatusBarMessage();
+		auto message = tr("Cannot save file\n%1:\n%2").arg(save_path, save_error);
+		save_error.clear();
+		QMessageBox::warning(window, tr("Error"), message);
+		return false;
+	}
+	
+	// Changes made while writing are not in the saved file.
+	if (!save_outdated && map->nonObjectRevision() == save_revision)
+	{
+		map->setHasUnsavedChanges(false);
+		map->undoManager().setClean();
+	}
+	
+#ifdef Q_OS_ANDROID
+	// Make the MediaScanner aware of the *updated* file.
+	Android::mediaScannerScanFile(QFileInfo(save_path).absolutePath());
+#endif
+	window->showStatusBarMessage(tr("Map saved"), 1000);
+	emit fileSaved(save_path, save_format);
+	return true;
+}
+
+
+bool MapEditorController::joinSaveThread()
+{
+	if (!save_thread.joinable())
+		return false;
+	
+	save_thread.join();
+	disconnect(save_changes_connection);
+	return true;
+}
+
+
+std::unique_ptr<Exporter> MapEditorController::makeExporter(const QString& path, const FileFormat& format)
+{
 	auto exporter = format.makeExporter(path, map, main_view);
 	if (!exporter)
 	{
@@ -607,29 +714,71 @@ bool MapEditorController::exportTo(const QString& path, const FileFormat& format
 		            format.description(),
 		            format.fileExtensions().join(QLatin1String(", ")) );
 		QMessageBox::warning(nullptr, tr("Error"), message);
-		return false;
 	}
-	
-	if (!exporter->doExport())
+	return exporter;
+}
+
+
+bool MapEditorController::runExporter(Exporter& exporter, const QString& path)
+{
+	if (!exporter.doExport())
 	{
 		auto message = tr("Cannot save file\n%1:\n%2")
-		               .arg(path, exporter->warnings().back());
+		               .arg(path, exporter.warnings().back());
 		QMessageBox::warning(nullptr, tr("Error"), message);
 		return false;
 	}
 	
-	if (!exporter->warnings().empty())
+	if (!exporter.warnings().empty())
 	{
 		MainWindow::showMessageBox(nullptr,
 		                           tr("Warning"),
 		                           tr("The map export generated warnings."),
-		                           exporter->warnings() );
+		                           exporter.warnings() );
 	}
 	
 	return true;
 }
 
 
+void MapEditorController::writeInBackground(const QString& path, const FileFormat& format, QByteArray data)
+{
+	Q_ASSERT(!save_thread.joinable());
+	
+	save_path = path;
+	save_format = &format;
+	save_error.clear();
+	save_outdated = false;
+	save_revision = map->nonObjectRevision();
+	save_changes_connection = connect(&map->undoManager(), &UndoManager::changeApplied, this, [this]() { save_outdated = true; });
+	save_thread = std::thread([this, path, data]() {
+		constexpr qsizetype chunk_size = 1 << 20;
+		auto last_percent = -1;
+		
+		QSaveFile file(path);
+		auto ok = file.open(QIODevice::WriteOnly);
+		for (qsizetype pos = 0; ok && pos < data.size(); pos += chunk_size)
+		{
+			auto const size = std::min(chunk_size, data.size() - pos);
+			ok = file.write(data.constData() + pos, size) == size;
+			auto const percent = int((pos + size) * 100 / data.size());
+			if (ok && percent != last_percent)
+			{
+				last_percent = percent;
+				QMetaObject::invokeMethod(this, [this, percent]() {
+					window->showStatusBarMessage(tr("Saving map... %1%").arg(percent));
+				}, Qt::QueuedConnection);
+			}
+		}
+		// QSaveFile::commit() synchronizes the data to disk before renaming.
+		if (!ok || !file.commit())
+			save_error = file.errorString();
+		
+		QMetaObject::invokeMethod(this, [this]() { finishSaving(); }, Qt::QueuedConnection);
+	});
+}
+
+
 bool MapEditorController::loadFrom(const QString& path, const FileFormat& format, QWidget* dialog_parent)
 {
 	if (!dialog_parent)
@@ -666,6 +815,10 @@ bool MapEditorController::loadFrom(const QString& path, const FileFormat& format
 		return false;
 	}
 	
+	auto warnings = importer->warnings();
+	if (!AutosaveJournal::replay(*map, path))
+		warnings.push_back(tr("Not all changes from the autosave journal could be recovered."));
+	
 	map->loadTemplateFilesAsync(*main_view, [controller = QPointer<MapEditorController>(this)](const QString& message) {
 		auto* window = controller ? controller->getWindow() : nullptr;
 		if (!window)
@@ -677,10 +830,9 @@ bool MapEditorController::loadFrom(const QString& path, const FileFormat& format
 	});
 	setMapAndView(map, main_view);
 	map->setHasUnsavedChanges(false);
-	if (!importer->warnings().empty())
+	if (!warnings.empty())
 	{
 		// Display warnings asynchronously, so that map and templates get visible.
-		auto warnings = importer->warnings();
 		auto show_warnings = [dialog_parent, warnings]() {
 			MainWindow::showMessageBox(dialog_parent,
 			                           tr("Warning"),
@@ -2876,23 +3028,22 @@ void MapEditorController::switchSymbolClicked()
 	else if (contained_types & Symbol::Line && !(contained_types & Symbol::Area))
 		split_up = true;
 	
-	if (close_paths)
-	{
-		replace_step = new ReplaceObjectsUndoStep(map);
-	}
-	else if (split_up)
+	if (split_up)
 	{
 		add_step = new AddObjectsUndoStep(map);
 		delete_step = new DeleteObjectsUndoStep(map);
 	}
 	else
 	{
+		// Only paths which are to be closed need a copy for undo.
+		if (close_paths)
+			replace_step = new ReplaceObjectsUndoStep(map);
 		switch_step = new SwitchSymbolUndoStep(map);
 	}
 	
 	for (auto* object : map->selectedObjects())
 	{
-		if (close_paths)
+		if (close_paths && hasOpenParts(object))
 		{
 			replace_step->addObject(part->findObjectIndex(object), object->duplicate());
 		}
@@ -2960,10 +3111,18 @@ void MapEditorController::switchSymbolClicked()
 	}
 	
 	map->setObjectsDirty();
-	if (close_paths)
+	if (replace_step && switch_step->isEmpty())
 	{
+		delete switch_step;
 		map->push(replace_step);
 	}
+	else if (replace_step && !replace_step->isEmpty())
+	{
+		auto* combined_step = new CombinedUndoStep(map);
+		combined_step->push(replace_step);
+		combined_step->push(switch_step);
+		map->push(combined_step);
+	}
 	else if (split_up)
 	{
 		auto* combined_step = new CombinedUndoStep(map);
@@ -2973,6 +3132,7 @@ void MapEditorController::switchSymbolClicked()
 	}
 	else
 	{
+		delete replace_step;
 		map->push(switch_step);
 	}
 	map->emitSelectionEdited();
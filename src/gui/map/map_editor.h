@@ -11,8 +11,10 @@
 #define LIBREMAPPER_MAP_EDITOR_H
 
 #include <memory>
+#include <thread>
 #include <vector>
 
+#include <QtGlobal>
 #include <QClipboard>
 #include <QHash>
 #include <QObject>
@@ -41,8 +43,10 @@ class QWidget;
 namespace LibreMapper {
 
 class ActionGridBar;
+class AutosaveJournal;
 class CompassDisplay;
 class EditorDockWidget;
+class Exporter;
 class FileFormat;
 class GPSDisplay;
 class GPSTemporaryMarkers;
@@ -225,6 +229,10 @@ public:
 	/** Override from MainWindowController */
 	bool exportTo(const QString& path, const FileFormat& format) override;
 	/** Override from MainWindowController */
+	bool autosaveTo(const QString& path, const FileFormat& format) override;
+	/** Override from MainWindowController */
+	bool finishSaving() override;
+	/** Override from MainWindowController */
 	bool loadFrom(const QString& path, const FileFormat& format, QWidget* dialog_parent = nullptr) override;
 	
 	/** Override from MainWindowController */
@@ -651,6 +659,37 @@ protected slots:
 private:
 	void setMapAndView(Map* map, MapView* map_view);
 	
+	/**
+	 * Creates an exporter for the map, or reports an error.
+	 */
+	std::unique_ptr<Exporter> makeExporter(const QString& path, const FileFormat& format);
+	
+	/**
+	 * Runs the exporter, and reports errors and warnings.
+	 */
+	bool runExporter(Exporter& exporter, const QString& path);
+	
+	/**
+	 * Writes a serialized map to the given path in a background thread.
+	 * 
+	 * The data is written via QSaveFile which synchronizes the file to disk
+	 * before replacing the original file. Progress is shown in the status bar.
+	 * Completion is handled by finishSaving(), which marks the map as saved
+	 * unless it was changed in the meantime.
+	 * 
+	 * Only the disk I/O runs in the background. The map must already be
+	 * serialized, on the GUI thread: there is no copy-on-write snapshot of
+	 * the map which an exporter could use on another thread.
+	 */
+	void writeInBackground(const QString& path, const FileFormat& format, QByteArray data);
+	
+	/**
+	 * Waits for the background saving thread, if any.
+	 * 
+	 * @return true if there was a thread to wait for, false otherwise
+	 */
+	bool joinSaveThread();
+	
 	/// Updates enabled state of all widgets
 	void updateWidgets();
 	
@@ -689,6 +728,17 @@ private:
 	
 	bool editing_in_progress;
 	
+	// Background saving
+	std::thread save_thread;
+	QString save_path;
+	QString save_error;
+	const FileFormat* save_format = nullptr;
+	quint64 save_revision = 0;
+	bool save_outdated = false;
+	QMetaObject::Connection save_changes_connection;
+	
+	std::unique_ptr<AutosaveJournal> autosave_journal;
+	
 	// Action handling
 	QHash<QByteArray, QAction*> actionsById;
 	
@@ -72,6 +72,18 @@ EditorSettingsPage::EditorSettingsPage(QWidget* parent)
 	keep_settings_of_closed_templates = new QCheckBox(tr("Templates: keep settings of closed templates"));
 	layout->addRow(keep_settings_of_closed_templates);
 	
+	map_template_raster_cache = new QCheckBox(tr("Templates: draw map templates from a raster cache"));
+	map_template_raster_cache->setToolTip(tr("Speeds up the display of large map templates, at the expense of memory and display quality"));
+	layout->addRow(map_template_raster_cache);
+	
+	paint_on_template_undo_memory = Util::SpinBox::create(1, 4096, tr("MiB", "mebibytes"));
+	layout->addRow(tr("Paint on template: memory for undo:"), paint_on_template_undo_memory);
+	
+	template_memory_budget = Util::SpinBox::create(0, 1048576, tr("MiB", "mebibytes"), 256);
+	template_memory_budget->setSpecialValueText(tr("Unlimited"));
+	template_memory_budget->setToolTip(tr("Templates which are hidden or were not displayed recently are closed temporarily when the loaded templates exceed this limit"));
+	layout->addRow(tr("Templates: memory limit:"), template_memory_budget);
+	
 	ignore_touch_input = new QCheckBox(tr("User input: Ignore display touch"));
 	layout->addRow(ignore_touch_input);
 	
@@ -130,6 +142,9 @@ void EditorSettingsPage::apply()
 	setSetting(Settings::MapEditor_ZoomOutAwayFromCursor, zoom_out_away_from_cursor->isChecked());
 	setSetting(Settings::MapEditor_DrawLastPointOnRightClick, draw_last_point_on_right_click->isChecked());
 	setSetting(Settings::Templates_KeepSettingsOfClosed, keep_settings_of_closed_templates->isChecked());
+	setSetting(Settings::Templates_MapRasterCache, map_template_raster_cache->isChecked());
+	setSetting(Settings::PaintOnTemplateTool_UndoMemoryMB, paint_on_template_undo_memory->value());
+	setSetting(Settings::Templates_MemoryBudgetMB, template_memory_budget->value());
 	setSetting(Settings::MapEditor_IgnoreTouchInput, ignore_touch_input->isChecked());
 	setSetting(Settings::EditTool_DeleteBezierPointAction, edit_tool_delete_bezier_point_action->currentData());
 	setSetting(Settings::EditTool_DeleteBezierPointActionAlternative, edit_tool_delete_bezier_point_action_alternative->currentData());
@@ -157,6 +172,9 @@ void EditorSettingsPage::updateWidgets()
 	zoom_out_away_from_cursor->setChecked(getSetting(Settings::MapEditor_ZoomOutAwayFromCursor).toBool());
 	draw_last_point_on_right_click->setChecked(getSetting(Settings::MapEditor_DrawLastPointOnRightClick).toBool());
 	keep_settings_of_closed_templates->setChecked(getSetting(Settings::Templates_KeepSettingsOfClosed).toBool());
+	map_template_raster_cache->setChecked(getSetting(Settings::Templates_MapRasterCache).toBool());
+	paint_on_template_undo_memory->setValue(getSetting(Settings::PaintOnTemplateTool_UndoMemoryMB).toInt());
+	template_memory_budget->setValue(getSetting(Settings::Templates_MemoryBudgetMB).toInt());
 	ignore_touch_input->setChecked(getSetting(Settings::MapEditor_IgnoreTouchInput).toBool());
 	
 	edit_tool_delete_bezier_point_action->setCurrentIndex(edit_tool_delete_bezier_point_action->findData(getSetting(Settings::EditTool_DeleteBezierPointAction).toInt()));
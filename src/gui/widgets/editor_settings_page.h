@@ -52,6 +52,9 @@ private:
 	QCheckBox* zoom_out_away_from_cursor;
 	QCheckBox* draw_last_point_on_right_click;
 	QCheckBox* keep_settings_of_closed_templates;
+	QCheckBox* map_template_raster_cache;
+	QSpinBox* paint_on_template_undo_memory;
+	QSpinBox* template_memory_budget;
 	QCheckBox* ignore_touch_input;
 	
 	QComboBox* edit_tool_delete_bezier_point_action;
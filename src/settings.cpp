@@ -135,6 +135,8 @@ Settings::Settings()
 	registerSetting(RectangleTool_PreviewLineWidth, "RectangleTool/preview_line_with", true);
 	
 	registerSetting(Templates_KeepSettingsOfClosed, "Templates/keep_settings_of_closed_templates", true);
+	registerSetting(Templates_MapRasterCache, "Templates/map_raster_cache", false);
+	registerSetting(Templates_MemoryBudgetMB, "Templates/memory_budget_mb", 0);  // 0: unlimited
 	
 	registerSetting(ActionGridBar_ButtonSizeMM, "ActionGridBar/button_size_mm", touch_button_minimum_size_default);
 	registerSetting(SymbolWidget_IconSizeMM, "SymbolWidget/icon_size_mm", symbol_widget_icon_size_mm_default);
@@ -159,6 +161,7 @@ Settings::Settings()
 	
 	// Paint On Template tool settings
 	registerSetting(PaintOnTemplateTool_Colors, "PaintOnTemplateTool/colors", QLatin1String("FF0000,FFFF00,00FF00,DB00D9,0000FF,D15C00,000000"));
+	registerSetting(PaintOnTemplateTool_UndoMemoryMB, "PaintOnTemplateTool/undo_memory_mb", 32);
 
 	// OCD file format compatibility settings
 	registerSetting(OcdCompatLeavePathsOpenOnImport, "OcdCompatibility/leavePathsOpenOnImport", false);
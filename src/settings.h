@@ -51,6 +51,8 @@ public:
 		RectangleTool_HelperCrossRadiusMM,
 		RectangleTool_PreviewLineWidth,
 		Templates_KeepSettingsOfClosed,
+		Templates_MapRasterCache,
+		Templates_MemoryBudgetMB,
 		SymbolWidget_IconSizeMM,
 		SymbolWidget_ShowCustomIcons,
 		ActionGridBar_ButtonSizeMM,
@@ -67,6 +69,7 @@ public:
 		HomeScreen_TipsVisible,
 		HomeScreen_CurrentTip,
 		PaintOnTemplateTool_Colors,
+		PaintOnTemplateTool_UndoMemoryMB,
 		OcdCompatLeavePathsOpenOnImport,
 		END_OF_SETTINGSENUM /* Don't add items below this line. */
 	};
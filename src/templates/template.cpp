@@ -10,6 +10,7 @@
 #include "template.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iosfwd>
 #include <iterator>
@@ -33,11 +34,14 @@
 #include <QRectF>
 #include <QSizeF>
 #include <QStringView>
+#include <QTimer>
 #include <QTransform>
+#include <QVariant>
 #include <QXmlStreamAttributes>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+#include "settings.h"
 #include "core/georeferencing.h"
 #include "core/map_view.h"
 #include "core/map.h"
@@ -56,6 +60,20 @@
 
 namespace LibreMapper {
 
+namespace {
+
+/// Templates displayed within this time are not unloaded for the memory budget.
+constexpr qint64 recent_usage_ms = 30000;
+
+qint64 steadyClockMSecs()
+{
+	using namespace std::chrono;
+	return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+
 class Template::ScopedOffsetReversal
 {
 public:
@@ -211,6 +229,8 @@ bool operator!=(const TemplateTransform& lhs, const TemplateTransform& rhs) noex
 
 bool Template::suppressAbsolutePaths = false;
 
+std::vector<Template*> Template::templates_in_memory;
+
 
 Template::Template(const QString& path, not_null<Map*> map)
 : map(map)
@@ -251,6 +271,8 @@ Template::Template(const Template& proto)
 Template::~Template()
 {
 	Q_ASSERT(template_state != Loaded);
+	templates_in_memory.erase(std::remove(begin(templates_in_memory), end(templates_in_memory), this),
+	                          end(templates_in_memory));
 }
 
 QString Template::errorString() const
@@ -263,6 +285,16 @@ void Template::setErrorString(const QString &text)
 	error_string = text;
 }
 
+void Template::setTemplateState(State state)
+{
+	template_state = state;
+	if (state != Loaded && state != Configuring)
+	{
+		templates_in_memory.erase(std::remove(begin(templates_in_memory), end(templates_in_memory), this),
+		                          end(templates_in_memory));
+	}
+}
+
 
 
 void Template::saveTemplateConfiguration(QXmlStreamWriter& xml, bool open, const QDir* map_dir) const
@@ -653,12 +685,12 @@ bool Template::loadTemplateFile()
 	{
 		if (!fileExists())
 		{
-			template_state = Invalid;
+			setTemplateState(Invalid);
 			setErrorString(tr("No such file."));
 		}
 		else if (!loadTemplateFileImpl())
 		{
-			template_state = Invalid;
+			setTemplateState(Invalid);
 			if (errorString().isEmpty())
 			{
 				qDebug("%s: Missing error message from failure in %s::loadTemplateFileImpl(bool)", \
@@ -667,26 +699,36 @@ bool Template::loadTemplateFile()
 				setErrorString(tr("Is the format of the file correct for this template type?"));
 			}
 		}
-		else if (old_state != Configuring)
+		else
 		{
-			template_state = Loaded;
-			setTemplateAreaDirty();
+			unloaded_for_memory_budget = false;
+			last_usage = steadyClockMSecs();
+			if (std::find(begin(templates_in_memory), end(templates_in_memory), this) == end(templates_in_memory))
+				templates_in_memory.push_back(this);
+			if (old_state != Configuring)
+			{
+				template_state = Loaded;
+				setTemplateAreaDirty();
+			}
 		}
 	}
 	catch (std::bad_alloc&)
 	{
-		template_state = Invalid;
+		setTemplateState(Invalid);
 		setErrorString(tr("Not enough free memory."));
 	}
 	catch (FileFormatException& e)
 	{
-		template_state = Invalid;
+		setTemplateState(Invalid);
 		setErrorString(e.message());
 	}
 	
 	if (old_state != template_state)
 		emit templateStateChanged();
-		
+	
+	if (template_state == Loaded)
+		enforceMemoryBudget(this);
+	
 	return template_state != Invalid;
 }
 
@@ -704,7 +746,7 @@ void Template::unloadTemplateFile()
 		setHasUnsavedChanges(false);
 	}
 	unloadTemplateFileImpl();
-	template_state = Unloaded;
+	setTemplateState(Unloaded);
 	emit templateStateChanged();
 }
 
@@ -936,6 +978,62 @@ bool Template::hasAlpha() const
 }
 
 
+qint64 Template::memoryUsage() const
+{
+	return 0;
+}
+
+void Template::recordUsage() const
+{
+	last_usage = steadyClockMSecs();
+	if (template_state == Unloaded && unloaded_for_memory_budget && !memory_reload_pending)
+	{
+		memory_reload_pending = true;
+		QTimer::singleShot(0, this, [this]() {
+			auto* temp = const_cast<Template*>(this);
+			temp->memory_reload_pending = false;
+			if (temp->template_state == Unloaded && temp->unloaded_for_memory_budget)
+				temp->loadTemplateFile();
+		});
+	}
+}
+
+// static
+void Template::enforceMemoryBudget(const Template* keep)
+{
+	auto const budget = qint64(Settings::getInstance().getSettingCached(Settings::Templates_MemoryBudgetMB).toInt()) * 1024 * 1024;
+	if (budget <= 0)
+		return;
+	
+	auto usage = qint64(0);
+	for (auto const* temp : templates_in_memory)
+		usage += temp->memoryUsage();
+	if (usage <= budget)
+		return;
+	
+	auto const now = steadyClockMSecs();
+	auto candidates = templates_in_memory;
+	candidates.erase(std::remove_if(begin(candidates), end(candidates), [keep, now](auto const* temp) {
+		return temp == keep
+		       || temp->getTemplateState() != Loaded
+		       || temp->hasUnsavedChanges()
+		       || now - temp->last_usage < recent_usage_ms;
+	}), end(candidates));
+	std::sort(begin(candidates), end(candidates), [](auto const* a, auto const* b) {
+		return a->last_usage < b->last_usage;
+	});
+	
+	for (auto* temp : candidates)
+	{
+		if (usage <= budget)
+			break;
+		usage -= temp->memoryUsage();
+		temp->unloadTemplateFile();
+		temp->unloaded_for_memory_budget = true;
+	}
+}
+
+
 
 const std::vector<QByteArray>& Template::supportedExtensions()
 {
@@ -542,7 +542,14 @@ public:
 	inline void setTemplateRelativePath(const QString& value) {template_relative_path = value;}
 	
 	inline State getTemplateState() const {return template_state;}
-	inline void setTemplateState(State state) {template_state = state;}
+	
+	/**
+	 * Changes the state without loading or unloading the template data.
+	 * 
+	 * Templates which are no longer loaded or configuring are removed from
+	 * the memory budget accounting.
+	 */
+	void setTemplateState(State state);
 	
 	inline int getTemplateGroup() const {return template_group;}
 	inline void setTemplateGroup(int value) {template_group = value;}
@@ -611,6 +618,26 @@ public:
 	virtual bool hasAlpha() const;
 	
 	
+	// Memory budget
+	
+	/**
+	 * Returns an estimate of the memory used by the loaded template data, in bytes.
+	 * 
+	 * The default implementation returns 0.
+	 */
+	virtual qint64 memoryUsage() const;
+	
+	/**
+	 * Records that the template is displayed.
+	 * 
+	 * Loaded templates which were not displayed recently are the first to be
+	 * unloaded when the Templates_MemoryBudgetMB setting is exceeded. If this
+	 * template was unloaded for this reason, it is reloaded from the event
+	 * loop.
+	 */
+	void recordUsage() const;
+	
+	
 	// Static
 	/**
 	 * Returns the filename extensions supported by known subclasses.
@@ -768,6 +795,27 @@ private:
 	 */
 	class ScopedOffsetReversal;
 	
+	/**
+	 * Unloads least recently displayed templates until the memory used by
+	 * all templates in memory is within the budget set by the user.
+	 * 
+	 * The given template, templates with unsaved changes, and templates which
+	 * were displayed very recently are never unloaded.
+	 */
+	static void enforceMemoryBudget(const Template* keep);
+	
+	/// All templates with loaded data, for the memory budget
+	static std::vector<Template*> templates_in_memory;
+	
+	/// The time of the last recordUsage() call (steady clock, in ms)
+	mutable qint64 last_usage = 0;
+	
+	/// Set when a reload for the memory budget is scheduled.
+	mutable bool memory_reload_pending = false;
+	
+	/// Set when the template was unloaded to meet the memory budget.
+	bool unloaded_for_memory_budget = false;
+	
 protected:
 	/// Currently active transformation. NOTE: after direct changes here call updateTransformationMatrices()
 	TemplateTransform transform;
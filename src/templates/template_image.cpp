@@ -10,6 +10,7 @@
 #include "template_image.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <iosfwd>
 #include <iterator>
 #include <utility>
@@ -37,6 +38,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+#include "settings.h"
 #include "core/georeferencing.h"
 #include "core/map.h"
 #include "core/map_coord.h"
@@ -65,6 +67,9 @@ TemplateImage::GeoreferencingOption readGdalGeoTransform(const QString& filepath
 
 namespace {
 
+/// The width and height of the image tiles saved for undo, in pixels.
+constexpr int undo_tile_size = 64;
+
 QByteArray findExportFormat(const QString& filename)
 {
 	auto const formats = QImageWriter::supportedImageFormats();
@@ -107,6 +112,8 @@ TemplateImage::TemplateImage(const TemplateImage& proto)
 , image(proto.image)
 // not copied: undo_steps
 // not copied: undo_index
+// not copied: undo_tile_pool
+// not copied: undo_memory
 , available_georef(proto.available_georef)
 , georef(new Georeferencing(*proto.georef))
 {
@@ -323,6 +330,7 @@ bool TemplateImage::postLoadSetup(QWidget* dialog_parent, bool& out_center_in_vi
 
 void TemplateImage::unloadTemplateFileImpl()
 {
+	clearUndoSteps();
 	image = QImage();
 }
 
@@ -351,6 +359,11 @@ void TemplateImage::drawTemplate(QPainter* painter, const QRectF& /*clip_rect*/,
 	painter->drawImage(QPointF(-image.width() * 0.5, -image.height() * 0.5), image);
 	painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
 }
+qint64 TemplateImage::memoryUsage() const
+{
+	return image.sizeInBytes() + undo_memory;
+}
+
 QRectF TemplateImage::getTemplateExtent() const
 {
     // If the image is invalid, the extent is an empty rectangle.
@@ -557,19 +570,33 @@ void TemplateImage::drawOntoTemplateImpl(MapCoordF* coords, int num_coords, cons
 		radius_bbox = radius_bbox.intersected(QRect(0, 0, image.width(), image.height()));
 	}
 	
-	// Create undo step
-	DrawOnImageUndoStep undo_step;
-	undo_step.x = radius_bbox.left();
-	undo_step.y = radius_bbox.top();
-	undo_step.image = image.copy(radius_bbox);
-	addUndoStep(undo_step);
-	
 	// This conversion is to prevent a very strange bug where the behavior of the
 	// default QPainter composition mode seems to be incorrect for images which are
-	// loaded from a file without alpha and then painted over with the eraser
+	// loaded from a file without alpha and then painted over with the eraser.
+	// It is done before capturing the undo tiles so that they match the image.
 	if (color.alpha() == 0 && image.format() != QImage::Format_ARGB32_Premultiplied)
 		image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
 	
+	// Create undo step
+	DrawOnImageUndoStep undo_step;
+	undo_step.format = image.format();
+	undo_step.color_table = image.colorTable();
+	auto const undo_area = radius_bbox.intersected(image.rect());
+	if (!undo_area.isEmpty())
+	{
+		auto const first_column = undo_area.left() / undo_tile_size;
+		auto const last_column  = undo_area.right() / undo_tile_size;
+		auto const first_row    = undo_area.top() / undo_tile_size;
+		auto const last_row     = undo_area.bottom() / undo_tile_size;
+		undo_step.tiles.reserve(std::size_t(last_column - first_column + 1) * std::size_t(last_row - first_row + 1));
+		for (auto row = first_row; row <= last_row; ++row)
+		{
+			for (auto column = first_column; column <= last_column; ++column)
+				undo_step.tiles.push_back(makeUndoTile(column, row));
+		}
+	}
+	addUndoStep(std::move(undo_step));
+	
 	QPainter painter(&image);
 	if (mode.testFlag(Antialias))
 		painter.setRenderHint(QPainter::Antialiasing);
@@ -629,40 +656,124 @@ void TemplateImage::drawOntoTemplateUndo(bool redo)
 	}
 	
 	DrawOnImageUndoStep& step = undo_steps[step_index];
-	QImage undo_image = step.image.copy();
-	step.image = image.copy(step.x, step.y, step.image.width(), step.image.height());
-	QPainter painter(&image);
-	painter.setCompositionMode(QPainter::CompositionMode_Source);
-	painter.drawImage(step.x, step.y, undo_image);
+	
+	// Save the current state of the tiles for the opposite operation.
+	DrawOnImageUndoStep opposite_step;
+	opposite_step.format = image.format();
+	opposite_step.color_table = image.colorTable();
+	opposite_step.tiles.reserve(step.tiles.size());
+	for (auto const& tile : step.tiles)
+		opposite_step.tiles.push_back(makeUndoTile(tile.column, tile.row));
+	
+	QRect dirty_area;
+	{
+		QPainter painter(&image);
+		painter.setCompositionMode(QPainter::CompositionMode_Source);
+		for (auto const& tile : step.tiles)
+		{
+			restoreUndoTile(painter, tile, step);
+			dirty_area |= undoTileRect(tile.column, tile.row);
+		}
+	}
+	
+	for (auto const& tile : step.tiles)
+		releaseUndoTile(tile);
+	step = std::move(opposite_step);
 	
 	undo_index += redo ? 1 : -1;
 	
-	qreal template_left = step.x - 0.5 * image.width();
-	qreal template_top = step.y - 0.5 * image.height();
+	if (dirty_area.isEmpty())
+		return;
+	
+	qreal template_left = dirty_area.left() - 0.5 * image.width();
+	qreal template_top = dirty_area.top() - 0.5 * image.height();
 	QRectF map_bbox;
 	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left, template_top)));
-	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + step.image.width(), template_top)));
-	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left, template_top + step.image.height())));
-	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + step.image.width(), template_top + step.image.height())));
+	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + dirty_area.width(), template_top)));
+	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left, template_top + dirty_area.height())));
+	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + dirty_area.width(), template_top + dirty_area.height())));
 	map->setTemplateAreaDirty(this, map_bbox, 0);
 	
 	setHasUnsavedChanges(true);
 }
 
-void TemplateImage::addUndoStep(const TemplateImage::DrawOnImageUndoStep& new_step)
+void TemplateImage::addUndoStep(TemplateImage::DrawOnImageUndoStep&& new_step)
 {
-	// TODO: undo step limitation based on used memory
-	const int max_undo_steps = 5;
-	
 	while (static_cast<int>(undo_steps.size()) > undo_index)
+	{
+		for (auto const& tile : undo_steps.back().tiles)
+			releaseUndoTile(tile);
 		undo_steps.pop_back();
-	while (static_cast<int>(undo_steps.size()) >= max_undo_steps)
-		undo_steps.erase(undo_steps.begin());
+	}
+	
+	undo_steps.push_back(std::move(new_step));
+	
+	// Drop the oldest steps when exceeding the memory limit,
+	// but always keep the most recent step.
+	auto const max_undo_memory = qsizetype(Settings::getInstance().getSettingCached(Settings::PaintOnTemplateTool_UndoMemoryMB).toInt()) * 1024 * 1024;
+	auto num_dropped = std::size_t(0);
+	while (undo_memory > max_undo_memory && undo_steps.size() - num_dropped > 1)
+	{
+		for (auto const& tile : undo_steps[num_dropped].tiles)
+			releaseUndoTile(tile);
+		++num_dropped;
+	}
+	undo_steps.erase(undo_steps.begin(), undo_steps.begin() + num_dropped);
 	
-	undo_steps.push_back(new_step);
 	undo_index = static_cast<int>(undo_steps.size());
 }
 
+void TemplateImage::clearUndoSteps()
+{
+	undo_steps.clear();
+	undo_index = 0;
+	undo_tile_pool.clear();
+	undo_memory = 0;
+}
+
+QRect TemplateImage::undoTileRect(int column, int row) const
+{
+	return QRect(column * undo_tile_size, row * undo_tile_size, undo_tile_size, undo_tile_size).intersected(image.rect());
+}
+
+TemplateImage::DrawOnImageUndoStep::Tile TemplateImage::makeUndoTile(int column, int row)
+{
+	auto const tile_image = image.copy(undoTileRect(column, row));
+	auto data = qCompress(tile_image.constBits(), int(tile_image.sizeInBytes()), 1);
+	
+	// Share the data with an equal tile, if possible.
+	auto pooled = undo_tile_pool.find(data);
+	if (pooled == undo_tile_pool.end())
+	{
+		undo_memory += data.size();
+		pooled = undo_tile_pool.insert(data, 0);
+	}
+	++pooled.value();
+	return { pooled.key(), column, row };
+}
+
+void TemplateImage::restoreUndoTile(QPainter& painter, const DrawOnImageUndoStep::Tile& tile, const DrawOnImageUndoStep& step) const
+{
+	auto const rect = undoTileRect(tile.column, tile.row);
+	auto const data = qUncompress(tile.data);
+	if (rect.isEmpty() || data.size() < rect.height())
+		return;
+	
+	QImage tile_image(reinterpret_cast<const uchar*>(data.constData()), rect.width(), rect.height(), data.size() / rect.height(), step.format);
+	tile_image.setColorTable(step.color_table);
+	painter.drawImage(rect.topLeft(), tile_image);
+}
+
+void TemplateImage::releaseUndoTile(const DrawOnImageUndoStep::Tile& tile)
+{
+	auto pooled = undo_tile_pool.find(tile.data);
+	if (pooled != undo_tile_pool.end() && --pooled.value() == 0)
+	{
+		undo_memory -= pooled.key().size();
+		undo_tile_pool.erase(pooled);
+	}
+}
+
 void TemplateImage::calculateGeoreferencing()
 {
 	if (!isGeoreferencingUsable())
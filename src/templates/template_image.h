@@ -16,13 +16,16 @@
 #include <QtGlobal>
 #include <QByteArray>
 #include <QColor>
+#include <QHash>
 #include <QImage>
 #include <QObject>
 #include <QPointF>
+#include <QRect>
 #include <QRectF>
 #include <QRgb>
 #include <QString>
 #include <QTransform>
+#include <QVector>
 
 #include "templates/template.h"
 
@@ -105,6 +108,8 @@ public:
     void drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const override;
 	QRectF getTemplateExtent() const override;
 	bool canBeDrawnOnto() const override { return drawable; }
+	
+	qint64 memoryUsage() const override;
 
 	/**
 	 * Calculates the image's center of gravity in template coordinates by
@@ -155,22 +160,51 @@ protected:
 	 */
 	bool isGeoreferencingUsable() const;
 	
-	/** Information about an undo step for the paint-on-template functionality. */
+	/**
+	 * Information about an undo step for the paint-on-template functionality.
+	 * 
+	 * The step holds compressed copies of the fixed-size image tiles which
+	 * are touched by the drawing. Equal tiles share their data.
+	 */
 	struct DrawOnImageUndoStep
 	{
-		/** Copy of previous image part */
-		QImage image;
+		/** A compressed copy of an image tile */
+		struct Tile
+		{
+			/** Compressed pixel data, interned in undo_tile_pool */
+			QByteArray data;
+			
+			/** Tile column */
+			int column;
+			
+			/** Tile row */
+			int row;
+		};
 		
-		/** X position of image part origin */
-		int x;
+		/** Copies of the tiles before the drawing (undo) or after it (redo) */
+		std::vector<Tile> tiles;
 		
-		/** Y position of image part origin */
-		int y;
+		/** The image format of the tile data */
+		QImage::Format format;
+		
+		/** The color table of the tile data, for indexed formats */
+		QVector<QRgb> color_table;
 	};
 	
 	void drawOntoTemplateImpl(MapCoordF* coords, int num_coords, const QColor& color, qreal width, ScribbleOptions mode) override;
 	void drawOntoTemplateUndo(bool redo) override;
-	void addUndoStep(const DrawOnImageUndoStep& new_step);
+	void addUndoStep(DrawOnImageUndoStep&& new_step);
+	void clearUndoSteps();
+	
+	/** Returns the image area covered by the given undo tile. */
+	QRect undoTileRect(int column, int row) const;
+	/** Creates an undo tile from the current image. */
+	DrawOnImageUndoStep::Tile makeUndoTile(int column, int row);
+	/** Draws an undo tile of the given step back to the image. */
+	void restoreUndoTile(QPainter& painter, const DrawOnImageUndoStep::Tile& tile, const DrawOnImageUndoStep& step) const;
+	/** Releases the tile's data from undo_tile_pool. */
+	void releaseUndoTile(const DrawOnImageUndoStep::Tile& tile);
+	
 	void calculateGeoreferencing();
 	void updatePosFromGeoreferencing();
 
@@ -179,6 +213,10 @@ protected:
 	std::vector< DrawOnImageUndoStep > undo_steps;
 	/// Current index in undo_steps, where 0 means before the first item.
 	int undo_index = 0;
+	/// Compressed tile data of all undo steps, with use counts.
+	QHash<QByteArray, int> undo_tile_pool;
+	/// The number of bytes in undo_tile_pool.
+	qsizetype undo_memory = 0;
 	/// A flag indicating that this template can be drawn onto.
 	bool drawable = false;
 	
@@ -9,11 +9,16 @@
 
 #include "template_map.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <utility>
 
+#include <Qt>
 #include <QtGlobal>
 #include <QByteArray>
 #include <QDialog>
+#include <QImage>
 #include <QPaintDevice>
 #include <QPainter>
 #include <QPoint>
@@ -47,6 +52,31 @@ namespace LibreMapper {
 
 namespace {
 
+/// The width and height of raster cache tiles, in pixels.
+constexpr int raster_tile_size = 512;
+
+/// The maximum number of tiles in the raster cache (256 MiB).
+constexpr std::size_t raster_cache_max_tiles = 256;
+
+
+/**
+ * Returns the number of device pixels per unit of the painter's current
+ * coordinate system.
+ * 
+ * This covers the view's zoom, the template transformation, and the device
+ * pixel ratio of HiDPI screens. For non-uniform scaling, the larger factor
+ * is returned so that raster data is never magnified.
+ */
+qreal deviceScaling(const QPainter& painter)
+{
+	auto const transform = painter.combinedTransform();
+	auto const scaling = std::max(std::hypot(transform.m11(), transform.m12()),
+	                              std::hypot(transform.m21(), transform.m22()));
+	auto const* device = painter.device();
+	return device ? scaling * device->devicePixelRatioF() : scaling;
+}
+
+
 /** 
  * Transform a template map to match the given map's georeferencing, using
  * an already determined transformation.
@@ -81,6 +111,7 @@ TemplateMap::TemplateMap(const QString& path, Map* map)
 	connect(&georef, &Georeferencing::projectionChanged, this, &TemplateMap::mapProjectionChanged);
 	// For connecting to virtual methods using PMF, we need to use a lambda.
 	connect(&georef, &Georeferencing::transformationChanged, this, [this]() { mapTransformationChanged(); });
+	connect(&Settings::getInstance(), &Settings::settingsChanged, this, &TemplateMap::invalidateRasterCache);
 }
 
 TemplateMap::TemplateMap(const TemplateMap& proto)
@@ -90,6 +121,7 @@ TemplateMap::TemplateMap(const TemplateMap& proto)
 	connect(&georef, &Georeferencing::projectionChanged, this, &TemplateMap::mapProjectionChanged);
 	// For connecting to virtual methods using PMF, we need to use a lambda.
 	connect(&georef, &Georeferencing::transformationChanged, this, [this]() { mapTransformationChanged(); });
+	connect(&Settings::getInstance(), &Settings::settingsChanged, this, &TemplateMap::invalidateRasterCache);
 }
 
 TemplateMap::~TemplateMap()
@@ -142,7 +174,9 @@ bool TemplateMap::loadTemplateFileImpl()
 	
 	if (new_template_valid)
 	{
+		invalidateRasterCache();
 		template_map = std::move(new_template_map);
+		objects_memory_usage = estimateObjectsMemoryUsage();
 		
 		if (property(ocdTransformProperty()).toBool())
 		{
@@ -223,7 +257,9 @@ bool TemplateMap::postLoadSetup(QWidget* dialog_parent, bool& out_center_in_view
 
 void TemplateMap::unloadTemplateFileImpl()
 {
+	invalidateRasterCache();
 	template_map.reset();
+	objects_memory_usage = 0;
 }
 
 void TemplateMap::drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const
@@ -247,6 +283,13 @@ void TemplateMap::drawTemplate(QPainter* painter, const QRectF& clip_rect, doubl
 		transformed_clip_rect = clip_rect;
 	}
 	
+	if (on_screen
+	    && Settings::getInstance().getSettingCached(Settings::Templates_MapRasterCache).toBool()
+	    && drawFromRasterCache(painter, transformed_clip_rect, deviceScaling(*painter), opacity))
+	{
+		return;
+	}
+	
 	RenderConfig::Options options;
 	auto scaling = scale;
 	if (on_screen)
@@ -268,6 +311,84 @@ void TemplateMap::drawTemplate(QPainter* painter, const QRectF& clip_rect, doubl
 	template_map->draw(painter, config);
 }
 
+bool TemplateMap::drawFromRasterCache(QPainter* painter, const QRectF& clip_rect, qreal scaling, qreal opacity) const
+{
+	if (scaling <= 0)
+		return false;
+	
+	if (!raster_cache_extent.isValid())
+	{
+		raster_cache_extent = template_map->calculateExtent(false, false, nullptr);
+		if (!raster_cache_extent.isValid())
+			return true;  // Nothing to draw
+	}
+	auto const visible_rect = clip_rect.intersected(raster_cache_extent);
+	if (visible_rect.isEmpty())
+		return true;
+	
+	// Tiles are rendered for the next power of two of the requested scaling,
+	// so that all zoom factors up to this level can reuse the same tiles.
+	auto const level = int(std::ceil(std::log2(scaling)));
+	auto const tile_scaling = std::ldexp(1.0, level);
+	auto const tile_extent = raster_tile_size / tile_scaling;
+	
+	auto const first_column = int(std::floor(visible_rect.left() / tile_extent));
+	auto const last_column  = int(std::floor(visible_rect.right() / tile_extent));
+	auto const first_row    = int(std::floor(visible_rect.top() / tile_extent));
+	auto const last_row     = int(std::floor(visible_rect.bottom() / tile_extent));
+	auto const num_tiles = std::size_t(last_column - first_column + 1) * std::size_t(last_row - first_row + 1);
+	if (num_tiles > raster_cache_max_tiles)
+		return false;
+	
+	if (raster_tiles.size() + num_tiles > raster_cache_max_tiles)
+	{
+		// Drop the tiles of other levels first, then everything.
+		for (auto it = begin(raster_tiles); it != end(raster_tiles); )
+		{
+			if (std::get<0>(it->first) != level)
+				it = raster_tiles.erase(it);
+			else
+				++it;
+		}
+		if (raster_tiles.size() + num_tiles > raster_cache_max_tiles)
+			raster_tiles.clear();
+	}
+	
+	painter->save();
+	painter->setOpacity(painter->opacity() * opacity);
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	for (auto row = first_row; row <= last_row; ++row)
+	{
+		for (auto column = first_column; column <= last_column; ++column)
+		{
+			auto const tile_rect = QRectF{column * tile_extent, row * tile_extent, tile_extent, tile_extent};
+			auto& tile = raster_tiles[RasterTileKey{level, column, row}];
+			if (tile.isNull())
+				tile = renderRasterTile(tile_rect, tile_scaling);
+			painter->drawImage(tile_rect, tile);
+		}
+	}
+	painter->restore();
+	return true;
+}
+
+QImage TemplateMap::renderRasterTile(const QRectF& tile_rect, qreal tile_scaling) const
+{
+	QImage tile(raster_tile_size, raster_tile_size, QImage::Format_ARGB32_Premultiplied);
+	tile.fill(Qt::transparent);
+	
+	QPainter tile_painter(&tile);
+	if (Settings::getInstance().getSettingCached(Settings::MapDisplay_Antialiasing).toBool())
+		tile_painter.setRenderHint(QPainter::Antialiasing);
+	tile_painter.scale(tile_scaling, tile_scaling);
+	tile_painter.translate(-tile_rect.topLeft());
+	
+	RenderConfig config = { *template_map, tile_rect, tile_scaling, {}, RenderConfig::Screen, 1.0 };
+	template_map->draw(&tile_painter, config);
+	tile_painter.end();
+	return tile;
+}
+
 QRectF TemplateMap::getTemplateExtent() const
 {
 	// If the template is invalid, the extent is an empty rectangle.
@@ -283,6 +404,29 @@ bool TemplateMap::hasAlpha() const
 	return template_map && template_map->hasAlpha();
 }
 
+qint64 TemplateMap::memoryUsage() const
+{
+	if (!template_map)
+		return 0;
+	
+	return objects_memory_usage + qint64(raster_tiles.size()) * raster_tile_size * raster_tile_size * 4;
+}
+
+qint64 TemplateMap::estimateObjectsMemoryUsage() const
+{
+	if (!template_map)
+		return 0;
+	
+	// A rough estimate, including path coords and renderables.
+	constexpr qint64 bytes_per_object = 1024;
+	constexpr qint64 bytes_per_coord = 96;
+	auto usage = qint64(0);
+	templateMap()->applyOnAllObjects([&usage](const Object* object) {
+		usage += bytes_per_object + bytes_per_coord * qint64(object->getRawCoordinateVector().size());
+	});
+	return usage;
+}
+
 
 bool TemplateMap::canChangeTemplateGeoreferenced() const
 {
@@ -319,6 +463,7 @@ bool TemplateMap::trySetTemplateGeoreferenced(bool value, QWidget* /*dialog_pare
 			
 			is_georeferenced = true;
 			transformMap(*template_map, *map, TemplateTransform::fromQTransform(q_transform));
+			invalidateRasterCache();
 			transform = {};
 			updateTransformationMatrices();
 			setTemplateAreaDirty();
@@ -344,7 +489,9 @@ std::unique_ptr<Map> TemplateMap::takeTemplateMap()
 	std::unique_ptr<Map> result;
 	if (template_state == Loaded)
 	{
+		invalidateRasterCache();
 		swap(result, template_map);
+		objects_memory_usage = 0;
 		setTemplateState(Unloaded);
 		emit templateStateChanged();
 	}
@@ -353,7 +500,9 @@ std::unique_ptr<Map> TemplateMap::takeTemplateMap()
 
 void TemplateMap::setTemplateMap(std::unique_ptr<Map>&& map)
 {
+	invalidateRasterCache();
 	template_map = std::move(map);
+	objects_memory_usage = estimateObjectsMemoryUsage();
 }
 
 
@@ -378,6 +527,7 @@ void TemplateMap::mapTransformationChanged()
 			auto const t = templ_georef.mapToProjected() * map_georef.projectedToMap();
 			templateMap()->applyOnAllObjects([&t](Object* o) { o->transform(t); });
 			templateMap()->setGeoreferencing(map_georef);
+			invalidateRasterCache();
 		}
 		else
 		{
@@ -397,6 +547,7 @@ void TemplateMap::reloadLater()
 {
 	if (reload_pending)
 		return;
+	invalidateRasterCache();
 	if (template_state == Loaded)
 		templateMap()->clear(); // no expensive operations before reloading
 	QTimer::singleShot(0, this, &TemplateMap::reload);
@@ -413,6 +564,13 @@ void TemplateMap::reload()
 }
 
 
+void TemplateMap::invalidateRasterCache()
+{
+	raster_tiles.clear();
+	raster_cache_extent = {};
+}
+
+
 bool TemplateMap::calculateTransformation(QTransform& q_transform) const
 {
 	if (!template_map)
@@ -10,18 +10,21 @@
 #ifndef LIBREMAPPER_TEMPLATE_MAP_H
 #define LIBREMAPPER_TEMPLATE_MAP_H
 
+#include <map>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 #include <QtGlobal>
+#include <QImage>
 #include <QObject>
+#include <QRectF>
 #include <QString>
 
 #include "templates/template.h"
 
 class QByteArray;
 class QPainter;
-class QRectF;
 class QTransform;
 class QWidget;
 
@@ -32,6 +35,11 @@ class Map;
 
 /**
  * Template displaying a map file.
+ * 
+ * When the Templates_MapRasterCache setting is enabled, on-screen drawing
+ * uses raster tiles which are rendered once per zoom level and kept until
+ * the template map changes. This trades memory and some display quality for
+ * speed with large map templates.
  */
 class TemplateMap : public Template
 {
@@ -74,6 +82,8 @@ public:
 	
 	bool hasAlpha() const override;
 	
+	qint64 memoryUsage() const override;
+	
 	
 	bool canChangeTemplateGeoreferenced() const override;
 	
@@ -106,6 +116,15 @@ protected:
 	void reload();
 	
 	
+	/**
+	 * Discards the raster tiles which are cached for drawing on screen.
+	 * 
+	 * This must be called whenever the template map's objects or appearance
+	 * are modified.
+	 */
+	void invalidateRasterCache();
+	
+	
 	bool calculateTransformation(QTransform& q_transform) const;
 	
 public:
@@ -132,7 +151,37 @@ public:
 private:
 	bool georeferencedStateSupported() const;
 	
+	/**
+	 * Draws the template map from the raster cache, rendering missing tiles.
+	 * 
+	 * The scaling is the number of device pixels per template map unit, as
+	 * established by the painter. Tiles are rendered at the next power of two
+	 * of this scaling.
+	 * 
+	 * Returns false if the visible area would need too many tiles, so that
+	 * the caller must fall back to regular drawing.
+	 */
+	bool drawFromRasterCache(QPainter* painter, const QRectF& clip_rect, qreal scaling, qreal opacity) const;
+	
+	/**
+	 * Renders a single raster cache tile.
+	 */
+	QImage renderRasterTile(const QRectF& tile_rect, qreal tile_scaling) const;
+	
+	/**
+	 * Estimates the memory used by the objects of the template map.
+	 * 
+	 * The result is cached in objects_memory_usage when the map is set.
+	 */
+	qint64 estimateObjectsMemoryUsage() const;
+	
+	/// Key of a raster tile: zoom level, tile column, tile row
+	using RasterTileKey = std::tuple<int, int, int>;
+	
 	std::unique_ptr<Map> template_map;
+	mutable std::map<RasterTileKey, QImage> raster_tiles;
+	mutable QRectF raster_cache_extent;
+	qint64 objects_memory_usage = 0;  ///< See estimateObjectsMemoryUsage()
 	bool reload_pending = false;
 	
 	/**
@@ -11,6 +11,7 @@
 
 // IWYU pragma: no_include <algorithm>
 #include <iterator>
+#include <utility>
 #include <vector>
 
 #include <QtGlobal>
@@ -130,18 +131,17 @@ UndoStep* CutoutOperation::finish()
 		return add_step;
 	}
 	
-	for (auto object : new_objects)
-	{
-		map->addObject(object);
-	}
-	// Do not merge this loop into the upper one;
-	// theoretically undo step indices could be wrong this way.
 	auto part = map->getCurrentPart();
 	auto delete_step = new DeleteObjectsUndoStep(map);
+	std::vector<std::pair<int, Object*>> objects_with_positions;
+	objects_with_positions.reserve(new_objects.size());
 	for (auto object : new_objects)
 	{
-		delete_step->addObject(part->findObjectIndex(object));
+		auto const index = part->getNumObjects() + int(objects_with_positions.size());
+		objects_with_positions.emplace_back(index, object);
+		delete_step->addObject(index);
 	}
+	part->addObjects(std::move(objects_with_positions));
 	map->emitSelectionChanged();
 	
 	auto combined_step = new CombinedUndoStep(map);
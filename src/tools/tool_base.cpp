@@ -515,7 +515,7 @@ void MapEditorToolBase::startEditing(Object* object)
 }
 
 
-void MapEditorToolBase::startEditing(const std::set<Object*>& objects)
+void MapEditorToolBase::startEditing(const ObjectSelection& objects)
 {
 	Q_ASSERT(!editingInProgress());
 	setEditingInProgress(true);
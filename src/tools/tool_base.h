@@ -11,7 +11,6 @@
 #define LIBREMAPPER_TOOL_BASE_H
 
 #include <memory>
-#include <set>
 #include <utility>
 #include <vector>
 
@@ -26,6 +25,7 @@
 
 #include "core/map_coord.h"
 #include "core/objects/object.h"
+#include "core/objects/object_selection.h"
 #include "tools/tool.h"
 
 class QAction;
@@ -217,7 +217,7 @@ protected:
 	/// Takes care of the preview renderables handling, map dirty flag, and objects edited signal.
 	void startEditing();
 	void startEditing(Object* object);
-	void startEditing(const std::set<Object*>& objects);
+	void startEditing(const ObjectSelection& objects);
 	void abortEditing();
 	
 	ObjectsRange editedObjects() { return ObjectsRange { edited_items }; }
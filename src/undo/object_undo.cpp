@@ -10,9 +10,13 @@
 #include "object_undo.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
 
 #include "core/map.h"
 #include "core/objects/object.h"
+#include "core/objects/text_object.h"
 #include "core/symbols/symbol.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_import_export.h"
@@ -29,6 +33,45 @@ namespace literal
 
 namespace LibreMapper {
 
+namespace {
+
+/**
+ * Returns an estimate of the memory occupied by the tags.
+ */
+std::size_t tagsMemoryUsage(const KeyValueContainer& tags)
+{
+	auto usage = tags.capacity() * sizeof(KeyValue);
+	for (const auto& tag : tags)
+		usage += std::size_t(tag.key.size() + tag.value.size()) * sizeof(QChar);
+	return usage;
+}
+
+/**
+ * Returns an estimate of the memory occupied by an object, without renderables.
+ */
+std::size_t objectMemoryUsage(const Object* object)
+{
+	auto usage = object->getRawCoordinateVector().capacity() * sizeof(MapCoord)
+	             + tagsMemoryUsage(object->tags());
+	switch (object->getType())
+	{
+	case Object::Point:
+		usage += sizeof(PointObject);
+		break;
+	case Object::Path:
+		usage += sizeof(PathObject) + object->asPath()->parts().capacity() * sizeof(PathPart);
+		break;
+	case Object::Text:
+		usage += sizeof(TextObject) + std::size_t(object->asText()->getText().size()) * sizeof(QChar);
+		break;
+	}
+	return usage;
+}
+
+}  // namespace
+
+
+
 // ### ObjectModifyingUndoStep ###
 
 ObjectModifyingUndoStep::ObjectModifyingUndoStep(Type type, Map* map)
@@ -86,6 +129,11 @@ void ObjectModifyingUndoStep::getModifiedObjects(int part_index, ObjectSet& out)
 	}
 }
 
+std::size_t ObjectModifyingUndoStep::memoryUsage() const
+{
+	return UndoStep::memoryUsage() + modified_objects.capacity() * sizeof(int);
+}
+
 
 
 void ObjectModifyingUndoStep::saveImpl(QXmlStreamWriter& xml) const
@@ -197,6 +245,14 @@ void ObjectCreatingUndoStep::getModifiedObjects(int part_index, ObjectSet& out)
 		out.insert(objects.begin(), objects.end());
 }
 
+std::size_t ObjectCreatingUndoStep::memoryUsage() const
+{
+	auto usage = ObjectModifyingUndoStep::memoryUsage() + objects.capacity() * sizeof(Object*);
+	for (const auto* object : objects)
+		usage += objectMemoryUsage(object);
+	return usage;
+}
+
 void ObjectCreatingUndoStep::saveImpl(QXmlStreamWriter& xml) const
 {
 	ObjectModifyingUndoStep::saveImpl(xml);
@@ -314,16 +370,13 @@ UndoStep* DeleteObjectsUndoStep::undo()
 	AddObjectsUndoStep* undo_step = new AddObjectsUndoStep(map);
 	undo_step->setPartIndex(part_index);
 	
-	// Make sure to delete the objects in the right order so the other objects' indices stay valid
-	std::sort(modified_objects.begin(), modified_objects.end(), std::greater<int>());
+	std::sort(modified_objects.begin(), modified_objects.end());
 	
 	MapPart* part = map->getPart(part_index);
-	int size = (int)modified_objects.size();
-	for (int i = 0; i < size; ++i)
-	{
-		undo_step->addObject(modified_objects[i], part->getObject(modified_objects[i]));
-		part->releaseObject(modified_objects[i]);
-	}
+	auto const released = part->releaseObjects(modified_objects);
+	Q_ASSERT(released.size() == modified_objects.size());
+	for (std::size_t i = 0; i < released.size(); ++i)
+		undo_step->addObject(modified_objects[i], released[i]);
 	
 	return undo_step;
 }
@@ -363,21 +416,17 @@ UndoStep* AddObjectsUndoStep::undo()
 	DeleteObjectsUndoStep* undo_step = new DeleteObjectsUndoStep(map);
 	undo_step->setPartIndex(part_index);
 	
-	// Make sure to add the objects in the right order so the other objects' indices stay valid
-	std::vector< std::pair<int, int> > order;	// index into affected_objects & objects, object index
-	order.resize(modified_objects.size());
-	for (int i = 0; i < (int)modified_objects.size(); ++i)
-		order[i] = std::pair<int, int>(i, modified_objects[i]);
-	std::sort(order.begin(), order.end(), sortOrder);
-	
-	MapPart* part = map->getPart(part_index);
-	int size = (int)objects.size();
-	for (int i = 0; i < size; ++i)
+	std::vector<std::pair<int, Object*>> objects_with_positions;
+	objects_with_positions.reserve(objects.size());
+	for (std::size_t i = 0; i < objects.size(); ++i)
 	{
-		undo_step->addObject(modified_objects[order[i].first]);
-		part->addObject(objects[order[i].first], order[i].second);
+		undo_step->addObject(modified_objects[i]);
+		objects_with_positions.emplace_back(modified_objects[i], objects[i]);
 	}
 	
+	MapPart* part = map->getPart(part_index);
+	part->addObjects(std::move(objects_with_positions));
+	
 	undone = true;
 	return undo_step;
 }
@@ -385,29 +434,25 @@ UndoStep* AddObjectsUndoStep::undo()
 void AddObjectsUndoStep::removeContainedObjects(bool emit_selection_changed)
 {
 	MapPart* part = map->getPart(getPartIndex());
-	int size = (int)objects.size();
+	std::vector<int> positions;
+	positions.reserve(objects.size());
 	bool object_deselected = false;
-	for (int i = 0; i < size; ++i)
+	for (auto* object : objects)
 	{
-		if (map->isObjectSelected(objects[i]))
+		if (map->isObjectSelected(object))
 		{
-			map->removeObjectFromSelection(objects[i], false);
+			map->removeObjectFromSelection(object, false);
 			object_deselected = true;
 		}
-		part->releaseObject(objects[i]);
-		map->setObjectsDirty();
+		if (part->contains(object))
+			positions.push_back(part->findObjectIndex(object));
 	}
+	part->releaseObjects(std::move(positions));
+	map->setObjectsDirty();
 	if (object_deselected && emit_selection_changed)
 		map->emitSelectionChanged();
 }
 
-bool AddObjectsUndoStep::sortOrder(const std::pair< int, int >& a, const std::pair< int, int >& b)
-{
-	return a.second < b.second;
-}
-
-
-
 // ### SwitchPartUndoStep ###
 
 SwitchPartUndoStep::SwitchPartUndoStep(Map *map, int source, int target_index)
@@ -567,6 +612,11 @@ UndoStep* SwitchSymbolUndoStep::undo()
 	return undo_step;
 }
 
+std::size_t SwitchSymbolUndoStep::memoryUsage() const
+{
+	return ObjectModifyingUndoStep::memoryUsage() + target_symbols.capacity() * sizeof(const Symbol*);
+}
+
 
 
 void SwitchSymbolUndoStep::saveImpl(QXmlStreamWriter& xml) const
@@ -712,6 +762,14 @@ UndoStep* ObjectTagsUndoStep::undo()
 	return redo_step;
 }
 
+std::size_t ObjectTagsUndoStep::memoryUsage() const
+{
+	auto usage = ObjectModifyingUndoStep::memoryUsage();
+	for (const auto& object_tags : object_tags_map)
+		usage += sizeof(ObjectTagsMap::value_type) + tagsMemoryUsage(object_tags.second);
+	return usage;
+}
+
 // override
 void ObjectTagsUndoStep::saveObject(XmlElementWriter& xml, int index) const
 {
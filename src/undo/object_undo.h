@@ -65,6 +65,14 @@ public:
 	 */
 	void setPartIndex(int part_index);
 	
+	/**
+	 * Returns the indices of the objects referenced by this undo step.
+	 * 
+	 * The indices refer to the state of the part at the time when this step
+	 * is undone.
+	 */
+	const std::vector<int>& affectedObjects() const;
+	
 	
 	/**
 	 * Returns true if no objects are modified by this undo step.
@@ -93,6 +101,8 @@ public:
 	 */
 	void getModifiedObjects(int part_index, ObjectSet& out) const override;
 	
+	std::size_t memoryUsage() const override;
+	
 	
 protected:
 	/**
@@ -201,6 +211,11 @@ public:
 	 */
 	void getModifiedObjects(int, ObjectSet&) const override;
 	
+	/**
+	 * Adds an estimate of the memory occupied by the contained objects.
+	 */
+	std::size_t memoryUsage() const override;
+	
 	
 public slots:
 	/**
@@ -299,9 +314,6 @@ public:
 	 */
 	void removeContainedObjects(bool emit_selection_changed);
 	
-protected:
-	static bool sortOrder(const std::pair<int, int>& a, const std::pair<int, int>& b);
-	
 private:
 	bool undone;
 };
@@ -357,6 +369,8 @@ public:
 	
 	UndoStep* undo() override;
 	
+	std::size_t memoryUsage() const override;
+	
 	
 public slots:
 	virtual void symbolChanged(int pos, const LibreMapper::Symbol* new_symbol, const LibreMapper::Symbol* old_symbol);
@@ -406,6 +420,8 @@ public:
 	
 	UndoStep* undo() override;
 	
+	std::size_t memoryUsage() const override;
+	
 protected:
 	void saveObject(XmlElementWriter& xml, int index) const override;
 	
@@ -425,6 +441,12 @@ int ObjectModifyingUndoStep::getPartIndex() const
 	return part_index;
 }
 
+inline
+const std::vector<int>& ObjectModifyingUndoStep::affectedObjects() const
+{
+	return modified_objects;
+}
+
 
 }  // namespace LibreMapper
 
@@ -102,6 +102,11 @@ void UndoStep::getModifiedObjects(int, ObjectSet&) const
 	; // nothing
 }
 
+std::size_t UndoStep::memoryUsage() const
+{
+	return sizeof(UndoStep);
+}
+
 // static
 UndoStep* UndoStep::load(QXmlStreamReader& xml, Map* map, SymbolDictionary& symbol_dict)
 {
@@ -185,6 +190,14 @@ void CombinedUndoStep::getModifiedObjects(int part_index, ObjectSet &out) const
 	}
 }
 
+std::size_t CombinedUndoStep::memoryUsage() const
+{
+	auto usage = UndoStep::memoryUsage() + steps.capacity() * sizeof(UndoStep*);
+	for (const auto* step : steps)
+		usage += step->memoryUsage();
+	return usage;
+}
+
 
 
 void CombinedUndoStep::saveImpl(QXmlStreamWriter& xml) const
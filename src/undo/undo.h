@@ -12,6 +12,7 @@
 
 #include "core/symbols/symbol.h"
 
+#include <cstddef>
 #include <set>
 #include <vector>
 
@@ -143,6 +144,15 @@ public:
 	 */
 	virtual void getModifiedObjects(int part_index, ObjectSet& out) const;
 	
+	/**
+	 * Returns an estimate of the memory occupied by this step, in bytes.
+	 * 
+	 * The UndoManager uses this value to limit the memory used for undo.
+	 * Implementations in derived classes shall add the size of their own
+	 * data to the value returned by the parent class' implementation.
+	 */
+	virtual std::size_t memoryUsage() const;
+	
 	
 	/**
 	 * Loads the undo step from the stream in xml format.
@@ -231,6 +241,11 @@ public:
 	 */
 	void getModifiedObjects(int part_index, ObjectSet& out) const override;
 	
+	/**
+	 * Returns the memory usage of all sub steps.
+	 */
+	std::size_t memoryUsage() const override;
+	
 	
 	/** 
 	 * Returns the number of sub steps.
@@ -247,6 +262,11 @@ public:
 	 */
 	UndoStep* getSubStep(int i);
 	
+	/** 
+	 * Returns the i-th sub step.
+	 */
+	const UndoStep* getSubStep(int i) const;
+	
 	
 protected:
 	/**
@@ -339,6 +359,12 @@ UndoStep* CombinedUndoStep::getSubStep(int i)
 	return steps[i];
 }
 
+inline
+const UndoStep* CombinedUndoStep::getSubStep(int i) const
+{
+	return steps[i];
+}
+
 
 }  // namespace LibreMapper
 
@@ -10,10 +10,13 @@
 #include "undo_manager.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
-#include <limits>
+#include <memory>
+#include <numeric>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
@@ -29,7 +32,42 @@
 
 namespace LibreMapper {
 
-Q_STATIC_ASSERT(UndoManager::max_undo_steps < static_cast<unsigned int>(std::numeric_limits<int>::max()));
+namespace {
+
+/**
+ * Returns the number of steps, starting from first, which fit into the memory budget.
+ * 
+ * The iterators refer to the memory usage of the steps.
+ * The first step is always counted, even if it exceeds the budget.
+ */
+template <class Iterator>
+typename std::iterator_traits<Iterator>::difference_type countStepsInBudget(Iterator first, Iterator last)
+{
+	auto count = typename std::iterator_traits<Iterator>::difference_type(0);
+	auto usage = std::size_t(0);
+	for (; first != last; ++first, ++count)
+	{
+		usage += *first;
+		if (usage > UndoManager::max_undo_memory && count > 0)
+			break;
+	}
+	return count;
+}
+
+/**
+ * Returns the memory usage of each of the given steps.
+ */
+std::vector<std::size_t> memoryUsage(const std::vector<std::unique_ptr<UndoStep>>& steps)
+{
+	std::vector<std::size_t> usage;
+	usage.reserve(steps.size());
+	for (const auto& step : steps)
+		usage.push_back(step->memoryUsage());
+	return usage;
+}
+
+}  // namespace
+
 
 
 // ### UndoManager::State ###
@@ -54,7 +92,6 @@ UndoManager::UndoManager(Map* map)
 , clean_state_index(-1)
 , loaded_state_index(-1)
 {
-	undo_steps.reserve(max_undo_steps + 1);  // +1 is for push before trim
 	if (map)
 	{
 		connect(map, &Map::symbolDeleted, this, [this]() {
@@ -79,6 +116,8 @@ void UndoManager::clear()
 		UndoManager::State const old_state(this);
 		
 		undo_steps.erase(begin(undo_steps), end(undo_steps));
+		step_memory.clear();
+		undo_memory = 0;
 		current_index = 0;
 		clean_state_index = old_state.is_clean ? 0 : -1;
 		loaded_state_index = old_state.is_loaded ? 0 : -1;
@@ -98,8 +137,11 @@ void UndoManager::push(std::unique_ptr<UndoStep>&& step)
 	clearRedoSteps();
 	
 	UndoManager::State const old_state(this);
+	step_memory.push_back(step->memoryUsage());
+	undo_memory += step_memory.back();
 	undo_steps.emplace_back(std::move(step));
 	++current_index;
+	emit changeApplied(undo_steps.back().get());
 	validateUndoSteps();
 	emitChangedSignals(old_state);
 }
@@ -143,6 +185,10 @@ bool UndoManager::undo(QWidget* dialog_parent)
 	
 	--current_index;
 	undo_steps[StepList::size_type(current_index)].reset(redo_step);
+	undo_memory -= step_memory[StepList::size_type(current_index)];
+	step_memory[StepList::size_type(current_index)] = redo_step->memoryUsage();
+	validateRedoSteps();
+	emit changeApplied(redo_step);
 	
 	emitChangedSignals(old_state);
 	
@@ -179,7 +225,11 @@ bool UndoManager::redo(QWidget* dialog_parent)
 	updateMapState(step);
 	
 	undo_steps[StepList::size_type(current_index)].reset(undo_step);
+	step_memory[StepList::size_type(current_index)] = undo_step->memoryUsage();
+	undo_memory += step_memory[StepList::size_type(current_index)];
 	++current_index;
+	validateUndoSteps();
+	emit changeApplied(undo_step);
 	
 	emitChangedSignals(old_state);
 	
@@ -279,6 +329,7 @@ void UndoManager::clearRedoSteps()
 	if (current_index < int(undo_steps.size()))
 	{
 		undo_steps.erase(begin(undo_steps) + StepList::difference_type(current_index), end(undo_steps));
+		step_memory.erase(begin(step_memory) + StepList::difference_type(current_index), end(step_memory));
 		if (clean_state_index > StepList::difference_type(current_index))
 			clean_state_index = -1;
 		if (loaded_state_index > StepList::difference_type(current_index))
@@ -293,9 +344,11 @@ void UndoManager::validateUndoSteps()
 {
 	if (current_index > 0)
 	{
+		// Drop the oldest steps until the remaining steps fit into the budget.
+		// The latest step is kept even if it alone exceeds the budget.
 		int num_removed_undo_steps = 0;
-		if (current_index > int(max_undo_steps))
-			num_removed_undo_steps += current_index - int(max_undo_steps);
+		for (auto usage = undo_memory; usage > max_undo_memory && num_removed_undo_steps + 1 < current_index; ++num_removed_undo_steps)
+			usage -= step_memory[StepList::size_type(num_removed_undo_steps)];
 		
 		auto rfirst = undo_steps.rend() - StepList::difference_type(current_index);
 		Q_ASSERT(rfirst->get() == nextUndoStep());
@@ -309,6 +362,9 @@ void UndoManager::validateUndoSteps()
 		
 		auto first = begin(undo_steps);
 		undo_steps.erase(first, first + num_removed_undo_steps);
+		auto first_memory = begin(step_memory);
+		undo_memory -= std::accumulate(first_memory, first_memory + num_removed_undo_steps, std::size_t(0));
+		step_memory.erase(first_memory, first_memory + num_removed_undo_steps);
 		current_index -= StepList::size_type(num_removed_undo_steps);
 		
 		if (clean_state_index >= 0)
@@ -326,17 +382,18 @@ void UndoManager::validateRedoSteps()
 {
 	if (current_index < int(undo_steps.size()))
 	{
-		auto num_removed_redo_steps = StepList::difference_type(0);
+		// Drop the farthest steps which do not fit into the budget.
+		// The next redo step is kept even if it alone exceeds the budget.
+		auto const first_memory = begin(step_memory) + StepList::difference_type(current_index);
+		auto const num_kept_redo_steps = countStepsInBudget(first_memory, end(step_memory));
 		
 		auto first = begin(undo_steps) + StepList::difference_type(current_index);
 		auto last = end(undo_steps);
-		first = std::find_if(first, last, [](auto&& step) { return !step->isValid(); });
-		if (first != last)
-			num_removed_redo_steps += std::distance(first, last);
-		
-		if (num_removed_redo_steps == 0)
+		first = std::find_if(first, first + num_kept_redo_steps, [](auto&& step) { return !step->isValid(); });
+		if (first == last)
 			return;
 		
+		step_memory.erase(begin(step_memory) + std::distance(begin(undo_steps), first), end(step_memory));
 		undo_steps.erase(first, last);
 		
 		if (clean_state_index > StepList::difference_type(undo_steps.size()))
@@ -377,8 +434,9 @@ void UndoManager::saveUndo(QXmlStreamWriter& xml) const
 	auto first = begin(undo_steps);
 	auto last  = first + count;
 	
-	// limit number of saved steps
-	first += qMax(0, count - int(max_undo_steps));
+	// limit memory of saved steps
+	auto last_memory = begin(step_memory) + count;
+	first = last - countStepsInBudget(std::make_reverse_iterator(last_memory), step_memory.rend());
 	// limit to valid steps
 	auto first_valid = last;
 	for (auto prev = first_valid; first_valid != first; first_valid = prev)
@@ -402,8 +460,9 @@ void UndoManager::saveRedo(QXmlStreamWriter& xml) const
 	auto first = undo_steps.rbegin();
 	auto last  = first + count;
 	
-	// limit number of saved steps
-	first += qMax(0, count - int(max_undo_steps));
+	// limit memory of saved steps
+	auto first_memory = begin(step_memory) + current_index;
+	first = last - countStepsInBudget(first_memory, end(step_memory));
 	// limit to valid steps
 	auto first_valid = last;
 	for (auto prev = first_valid; first_valid != first; first_valid = prev)
@@ -427,13 +486,17 @@ void UndoManager::loadUndo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict)
 	Q_ASSERT(xml.name() == QLatin1String("undo"));
 	
 	auto loaded_steps = loadSteps(xml, symbol_dict);
-	if (loaded_steps.size() > max_undo_steps)
-		loaded_steps.erase(begin(loaded_steps), begin(loaded_steps) + StepList::difference_type(loaded_steps.size() - max_undo_steps));
+	auto loaded_memory = memoryUsage(loaded_steps);
+	auto const num_kept_steps = countStepsInBudget(loaded_memory.rbegin(), loaded_memory.rend());
+	loaded_steps.erase(begin(loaded_steps), end(loaded_steps) - num_kept_steps);
+	loaded_memory.erase(begin(loaded_memory), end(loaded_memory) - num_kept_steps);
 	
 	clear();
 	UndoManager::State old_state(this);
 	using std::swap;
 	swap(undo_steps, loaded_steps);
+	swap(step_memory, loaded_memory);
+	undo_memory = std::accumulate(begin(step_memory), end(step_memory), std::size_t(0));
 	current_index = int(undo_steps.size());
 	setLoaded();
 	setClean();
@@ -446,13 +509,16 @@ void UndoManager::loadRedo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict)
 	Q_ASSERT(xml.name() == QLatin1String("redo"));
 	
 	auto loaded_steps = loadSteps(xml, symbol_dict);
-	auto capacity = max_undo_steps - undo_steps.size();
-	if (loaded_steps.size() > capacity)
-		loaded_steps.erase(begin(loaded_steps) + StepList::difference_type(loaded_steps.size() - capacity), end(loaded_steps));
+	auto loaded_memory = memoryUsage(loaded_steps);
+	// The last loaded step is the next redo step.
+	auto const num_kept_steps = countStepsInBudget(loaded_memory.rbegin(), loaded_memory.rend());
+	loaded_steps.erase(begin(loaded_steps), end(loaded_steps) - num_kept_steps);
+	loaded_memory.erase(begin(loaded_memory), end(loaded_memory) - num_kept_steps);
 		
 	clearRedoSteps();
 	UndoManager::State old_state(this);
 	std::move(loaded_steps.rbegin(), loaded_steps.rend(), std::back_inserter(undo_steps)); 
+	step_memory.insert(end(step_memory), loaded_memory.rbegin(), loaded_memory.rend());
 	emitChangedSignals(old_state);
 }
 
@@ -460,7 +526,6 @@ void UndoManager::loadRedo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict)
 UndoManager::StepList UndoManager::loadSteps(QXmlStreamReader& xml, SymbolDictionary& symbol_dict) const
 {
 	StepList steps;
-	steps.reserve(max_undo_steps + 1);
 	while (xml.readNextStartElement())
 	{
 		if (xml.name() == QLatin1String("step"))
@@ -184,13 +184,15 @@ public:
 	
 	
 	/**
-	 * The maximum number of steps kept for undo() and redo(), respectively.
+	 * The maximum memory occupied by the steps kept for undo() and redo(),
+	 * respectively, in bytes.
 	 * 
-	 * This limits the amount of memory occupied by undo steps.
+	 * The memory of a step is estimated by UndoStep::memoryUsage().
+	 * The latest step is kept even if it alone exceeds this limit.
 	 * 
-	 * @todo Make this configurable (maybe by used memory instead of step count)
+	 * @todo Make this configurable
 	 */
-	static constexpr std::size_t max_undo_steps = 128;
+	static constexpr std::size_t max_undo_memory = std::size_t(64) << 20;
 	
 signals:
 	/**
@@ -213,6 +215,15 @@ signals:
 	 */
 	void loadedChanged(bool loaded);
 	
+	/**
+	 * This signal is emitted after a change was applied to the map.
+	 * 
+	 * The given step is the one which reverts the change. It is emitted for
+	 * steps added by push(), and for the steps created by undo() and redo().
+	 * Indices in the step refer to the current state of the map.
+	 */
+	void changeApplied(const LibreMapper::UndoStep* reverse_step);
+	
 protected:
 	/**
 	 * A list of UndoSteps.
@@ -227,22 +238,22 @@ protected:
 	/**
 	 * Validates the list of steps available for undo().
 	 * 
-	 * In order to maintain the validness of current_index etc., this
-	 * method does not remove elements from undo_steps.
-	 * Instead, it replaces steps which are no longer reachable via valid steps,
-	 * or which exceed the max_undo_steps limit, with invalid NoOpUndoStep objects,
-	 * thus releasing the memory which was originally occupied by now obsolete
-	 * undo steps.
+	 * This method removes the steps from the start of undo_steps which are no
+	 * longer reachable via valid steps, or which exceed the max_undo_memory
+	 * limit, and adjusts current_index etc. accordingly, thus releasing the
+	 * memory which was originally occupied by now obsolete undo steps.
+	 * The next step for undo() is kept even if it alone exceeds the limit.
 	 */
 	void validateUndoSteps();
 	
 	/**
 	 * Validates the list of steps available for redo().
 	 * 
-	 * This method removes elements from undo_steps which are no longer reachable
-	 * via valid steps, or which exceed the max_undo_steps limit, with invalid
-	 * NoOpUndoStep objects, thus releasing the memory which was originally
-	 * occupied by now obsolete undo steps.
+	 * This method removes the steps from the end of undo_steps which are no
+	 * longer reachable via valid steps, or which exceed the max_undo_memory
+	 * limit, thus releasing the memory which was originally occupied by now
+	 * obsolete redo steps. The next step for redo() is kept even if it alone
+	 * exceeds the limit.
 	 */
 	void validateRedoSteps();
 	
@@ -289,6 +300,18 @@ private:
 	 */
 	StepList undo_steps;
 	
+	/**
+	 * The memory usage of the steps in undo_steps, at the same indices.
+	 * 
+	 * The values are estimated once, when the steps are added.
+	 */
+	std::vector<std::size_t> step_memory;
+	
+	/**
+	 * The sum of step_memory for the steps available for undo().
+	 */
+	std::size_t undo_memory = 0;
+	
 	/**
 	 * The map which this UndoManager operates on.
 	 */
@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#include "concurrency.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+#include <QtGlobal>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+
+namespace LibreMapper {
+
+std::size_t concurrentWorkers(std::size_t count, std::size_t chunk_size)
+{
+	auto const ideal_threads = std::size_t(qMax(1, QThread::idealThreadCount()));
+	return std::max(std::size_t(1), std::min(ideal_threads, count / std::max(chunk_size, std::size_t(1))));
+}
+
+
+void processConcurrently(std::size_t count, std::size_t chunk_size, const ChunkFunction& function)
+{
+	chunk_size = std::max(chunk_size, std::size_t(1));
+	
+	std::atomic<std::size_t> next_chunk { 0 };
+	std::atomic<bool> failed { false };
+	std::mutex error_mutex;
+	std::exception_ptr error;
+	auto work = [&](std::size_t worker) {
+		try
+		{
+			for (auto first = next_chunk.fetch_add(chunk_size); first < count && !failed; first = next_chunk.fetch_add(chunk_size))
+				function(first, std::min(first + chunk_size, count), worker);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(error_mutex);
+			if (!error)
+				error = std::current_exception();
+			failed = true;
+		}
+	};
+	
+	// Only idle pool threads are used. Queued tasks could wait for threads
+	// which are blocked in this function themselves.
+	auto const num_workers = concurrentWorkers(count, chunk_size);
+	QSemaphore finished;
+	int started = 0;
+	auto* pool = QThreadPool::globalInstance();
+	for (std::size_t worker = 1; worker < num_workers; ++worker)
+	{
+		if (!pool->tryStart([&work, &finished, worker]() { work(worker); finished.release(); }))
+			break;
+		++started;
+	}
+	work(0);
+	finished.acquire(started);
+	
+	if (error)
+		std::rethrow_exception(error);
+}
+
+
+}  // namespace LibreMapper
@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#ifndef LIBREMAPPER_CONCURRENCY_H
+#define LIBREMAPPER_CONCURRENCY_H
+
+#include <cstddef>
+#include <functional>
+
+namespace LibreMapper {
+
+
+/**
+ * A function which processes the index range [first, last) of a larger job.
+ * 
+ * The worker parameter identifies the thread calling the function. It is
+ * less than the value returned by concurrentWorkers() for the job, and it
+ * may be used to select per-thread state.
+ */
+using ChunkFunction = std::function<void (std::size_t first, std::size_t last, std::size_t worker)>;
+
+
+/**
+ * Returns the maximum number of threads used by processConcurrently().
+ * 
+ * This is the number of complete chunks, limited to the ideal number of
+ * threads, but at least 1.
+ */
+std::size_t concurrentWorkers(std::size_t count, std::size_t chunk_size);
+
+/**
+ * Calls the function for all chunks of the index range [0, count), using
+ * the calling thread and idle threads from the global thread pool.
+ * 
+ * Chunks are handed out in order, but they may be processed in any order.
+ * Jobs with fewer than two complete chunks run on the calling thread only.
+ * Pool threads are never waited for before they started, so this function
+ * may be used from within pool threads, too.
+ * 
+ * If the function throws, no further chunks are started. The first
+ * exception is rethrown after all threads finished their current chunk.
+ */
+void processConcurrently(std::size_t count, std::size_t chunk_size, const ChunkFunction& function);
+
+
+}  // namespace LibreMapper
+
+#endif // LIBREMAPPER_CONCURRENCY_H
@@ -0,0 +1,302 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#include "gzip_device.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include <QScopeGuard>
+#include <QString>
+
+#include <zlib.h>
+
+#include "util/concurrency.h"
+
+
+namespace LibreMapper {
+
+namespace {
+
+/// The amount of uncompressed data in each gzip member
+constexpr qint64 block_size = 1 << 20;
+
+/// The amount of compressed data read from the source at once
+constexpr qint64 input_size = 1 << 16;
+
+/// gzip encoding for deflateInit2() and inflateInit2()
+constexpr int gzip_window_bits = MAX_WBITS + 16;
+
+
+/**
+ * Compresses the data to a complete gzip member.
+ * 
+ * Returns an empty array on error.
+ */
+QByteArray compressBlock(const QByteArray& data)
+{
+	z_stream stream = {};
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzip_window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return {};
+	auto const cleanup = qScopeGuard([&stream]() { deflateEnd(&stream); });
+	
+	QByteArray result(qsizetype(deflateBound(&stream, uLong(data.size()))), Qt::Uninitialized);
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+	stream.avail_in = uInt(data.size());
+	stream.next_out = reinterpret_cast<Bytef*>(result.data());
+	stream.avail_out = uInt(result.size());
+	if (deflate(&stream, Z_FINISH) != Z_STREAM_END)
+		return {};
+	
+	result.truncate(qsizetype(stream.total_out));
+	return result;
+}
+
+
+}  // namespace
+
+
+
+// ### GzipCompressingDevice ###
+
+GzipCompressingDevice::GzipCompressingDevice(QIODevice& target)
+: target(target)
+, batch_size(concurrentWorkers(std::numeric_limits<std::size_t>::max(), 1))
+{
+	block.reserve(block_size);
+	pending.reserve(batch_size);
+}
+
+GzipCompressingDevice::~GzipCompressingDevice()
+{
+	if (isOpen())
+		close();
+}
+
+
+bool GzipCompressingDevice::isSequential() const
+{
+	return true;
+}
+
+
+bool GzipCompressingDevice::finish()
+{
+	// An empty input still needs a gzip member.
+	if ((!block.isEmpty() || !submitted) && !submitBlock())
+		return false;
+	return writeCompressed();
+}
+
+
+void GzipCompressingDevice::close()
+{
+	finish();
+	QIODevice::close();
+}
+
+
+qint64 GzipCompressingDevice::readData(char* /*data*/, qint64 /*max_size*/)
+{
+	return -1;
+}
+
+
+qint64 GzipCompressingDevice::writeData(const char* data, qint64 size)
+{
+	if (failed)
+		return -1;
+	
+	for (auto remaining = size; remaining > 0; )
+	{
+		auto const chunk = std::min(remaining, block_size - block.size());
+		block.append(data, qsizetype(chunk));
+		data += chunk;
+		remaining -= chunk;
+		if (block.size() == block_size && !submitBlock())
+			return -1;
+	}
+	return size;
+}
+
+
+bool GzipCompressingDevice::submitBlock()
+{
+	pending.push_back(std::move(block));
+	submitted = true;
+	block = QByteArray();
+	block.reserve(block_size);
+	if (pending.size() < batch_size)
+		return !failed;
+	return writeCompressed();
+}
+
+
+bool GzipCompressingDevice::writeCompressed()
+{
+	auto compressed_blocks = std::vector<QByteArray>(pending.size());
+	if (!failed)
+	{
+		processConcurrently(pending.size(), 1, [this, &compressed_blocks](std::size_t first, std::size_t last, std::size_t /*worker*/) {
+			for (auto i = first; i < last; ++i)
+				compressed_blocks[i] = compressBlock(pending[i]);
+		});
+	}
+	pending.clear();
+	
+	for (auto const& compressed : compressed_blocks)
+	{
+		if (failed)
+			break;
+		
+		if (compressed.isEmpty())
+		{
+			setErrorString(tr("Failed to compress the data."));
+			failed = true;
+		}
+		else if (target.write(compressed) != compressed.size())
+		{
+			setErrorString(target.errorString());
+			failed = true;
+		}
+	}
+	return !failed;
+}
+
+
+
+// ### GzipDecompressingDevice ###
+
+struct GzipDecompressingDevice::Stream
+{
+	z_stream z = {};
+	
+	Stream()
+	{
+		if (inflateInit2(&z, gzip_window_bits) != Z_OK)
+			throw std::bad_alloc();
+	}
+	
+	~Stream()
+	{
+		inflateEnd(&z);
+	}
+	
+	Stream(const Stream&) = delete;
+	Stream& operator=(const Stream&) = delete;
+};
+
+
+GzipDecompressingDevice::GzipDecompressingDevice(QIODevice& source)
+: source(source)
+, stream(std::make_unique<Stream>())
+{
+	// nothing else
+}
+
+GzipDecompressingDevice::~GzipDecompressingDevice() = default;
+
+
+bool GzipDecompressingDevice::isSequential() const
+{
+	return true;
+}
+
+
+bool GzipDecompressingDevice::atEnd() const
+{
+	return finished && QIODevice::atEnd();
+}
+
+
+// static
+bool GzipDecompressingDevice::hasSignature(const char* data, qint64 size)
+{
+	// ID1, ID2, and CM = deflate
+	return size >= 3 && data[0] == '\x1f' && data[1] == '\x8b' && data[2] == '\x08';
+}
+
+
+// static
+QByteArray GzipDecompressingDevice::decompressPrefix(const char* data, qint64 size, int max_size)
+{
+	z_stream stream = {};
+	if (inflateInit2(&stream, gzip_window_bits) != Z_OK)
+		return {};
+	auto const cleanup = qScopeGuard([&stream]() { inflateEnd(&stream); });
+	
+	QByteArray result(max_size, Qt::Uninitialized);
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	stream.avail_in = uInt(std::min<qint64>(size, std::numeric_limits<uInt>::max()));
+	stream.next_out = reinterpret_cast<Bytef*>(result.data());
+	stream.avail_out = uInt(result.size());
+	inflate(&stream, Z_SYNC_FLUSH);  // Errors are expected for truncated data.
+	result.truncate(qsizetype(stream.total_out));
+	return result;
+}
+
+
+qint64 GzipDecompressingDevice::readData(char* data, qint64 max_size)
+{
+	if (finished)
+		return -1;
+	
+	auto& z = stream->z;
+	auto const out_size = uInt(std::min<qint64>(max_size, std::numeric_limits<uInt>::max()));
+	z.next_out = reinterpret_cast<Bytef*>(data);
+	z.avail_out = out_size;
+	while (z.avail_out > 0)
+	{
+		if (z.avail_in == 0)
+		{
+			input = source.read(input_size);
+			if (input.isEmpty())
+			{
+				if (!member_finished)
+				{
+					setErrorString(tr("Unexpected end of compressed data."));
+					return -1;
+				}
+				finished = true;
+				break;
+			}
+			z.next_in = reinterpret_cast<Bytef*>(input.data());
+			z.avail_in = uInt(input.size());
+		}
+		
+		if (member_finished)
+		{
+			// Another gzip member follows.
+			inflateReset(&z);
+			member_finished = false;
+		}
+		
+		auto const result = inflate(&z, Z_NO_FLUSH);
+		if (result == Z_STREAM_END)
+		{
+			member_finished = true;
+		}
+		else if (result != Z_OK)
+		{
+			setErrorString(z.msg ? QString::fromLatin1(z.msg) : tr("Invalid compressed data."));
+			return -1;
+		}
+	}
+	
+	auto const produced = qint64(out_size - z.avail_out);
+	return (produced == 0 && finished) ? -1 : produced;
+}
+
+
+qint64 GzipDecompressingDevice::writeData(const char* /*data*/, qint64 /*size*/)
+{
+	return -1;
+}
+
+
+}  // namespace LibreMapper
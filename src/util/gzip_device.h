@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * 
+ * Copyright 2026 LibreMapper contributors
+ * 
+ * This file is part of LibreMapper.
+ */
+
+#ifndef LIBREMAPPER_GZIP_DEVICE_H
+#define LIBREMAPPER_GZIP_DEVICE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QIODevice>
+#include <QObject>
+
+namespace LibreMapper {
+
+
+/**
+ * A write-only device which writes gzip-compressed data to another device.
+ * 
+ * The data is split into blocks, each compressed to a separate gzip member.
+ * The concatenation of these members is a regular gzip file. Batches of
+ * blocks are compressed concurrently, via processConcurrently().
+ * 
+ * Call finish() or close() to write the remaining data. The target device
+ * is not closed.
+ */
+class GzipCompressingDevice : public QIODevice
+{
+	Q_OBJECT
+
+public:
+	explicit GzipCompressingDevice(QIODevice& target);
+	
+	~GzipCompressingDevice() override;
+	
+	bool isSequential() const override;
+	
+	/**
+	 * Compresses and writes all pending data.
+	 *
+	 * @return false on error, with errorString() providing details
+	 */
+	bool finish();
+	
+	/**
+	 * Calls finish() and closes the device.
+	 */
+	void close() override;
+
+protected:
+	qint64 readData(char* data, qint64 max_size) override;
+	
+	qint64 writeData(const char* data, qint64 size) override;
+
+private:
+	/**
+	 * Adds the current block to the pending blocks.
+	 * 
+	 * A full batch of pending blocks is compressed and written.
+	 */
+	bool submitBlock();
+	
+	/**
+	 * Compresses all pending blocks concurrently, and writes them in order.
+	 */
+	bool writeCompressed();
+	
+	QIODevice& target;
+	QByteArray block;
+	std::vector<QByteArray> pending;
+	std::size_t batch_size;
+	bool submitted = false;
+	bool failed = false;
+	
+};
+
+
+
+/**
+ * A read-only device which decompresses gzip data from another device.
+ * 
+ * Concatenated gzip members are read as a single stream.
+ */
+class GzipDecompressingDevice : public QIODevice
+{
+	Q_OBJECT
+
+public:
+	explicit GzipDecompressingDevice(QIODevice& source);
+	
+	~GzipDecompressingDevice() override;
+	
+	bool isSequential() const override;
+	
+	bool atEnd() const override;
+	
+	
+	/**
+	 * Returns true if the data starts with the gzip signature.
+	 */
+	static bool hasSignature(const char* data, qint64 size);
+	
+	/**
+	 * Decompresses the start of the given gzip data.
+	 *
+	 * The data may be truncated. The result is limited to max_size bytes.
+	 */
+	static QByteArray decompressPrefix(const char* data, qint64 size, int max_size);
+
+protected:
+	qint64 readData(char* data, qint64 max_size) override;
+	
+	qint64 writeData(const char* data, qint64 size) override;
+
+private:
+	struct Stream;
+	
+	QIODevice& source;
+	QByteArray input;
+	std::unique_ptr<Stream> stream;
+	bool member_finished = false;
+	bool finished = false;
+	
+};
+
+
+}  // namespace LibreMapper
+
+#endif // LIBREMAPPER_GZIP_DEVICE_H
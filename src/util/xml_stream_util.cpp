@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <exception>
 #include <limits>
 #include <stdexcept>
@@ -158,15 +159,71 @@ bool XmlRecoveryHelper::operator() ()
 
 
 
+//### XmlCoordColumns ###
+
+XmlCoordColumns::XmlCoordColumns(const qint32* x, const qint32* y, const quint8* flags, std::size_t size) noexcept
+: x_data(x)
+, y_data(y)
+, flags_data(flags)
+, size_(size)
+{}
+
+std::size_t XmlCoordColumns::append(const MapCoordVector& coords)
+{
+	Q_ASSERT(!x_data);
+	auto const first = size_;
+	x_column.reserve(size_ + coords.size());
+	y_column.reserve(size_ + coords.size());
+	flags_column.reserve(size_ + coords.size());
+	for (auto const& coord : coords)
+	{
+		x_column.push_back(coord.nativeX());
+		y_column.push_back(coord.nativeY());
+		flags_column.push_back(quint8(coord.flags()));
+	}
+	size_ = x_column.size();
+	return first;
+}
+
+thread_local XmlCoordColumns* XmlCoordColumns::active_columns = nullptr;
+
+
+XmlCoordColumns::Scope::Scope(XmlCoordColumns& columns) noexcept
+: previous(active_columns)
+{
+	active_columns = &columns;
+}
+
+XmlCoordColumns::Scope::~Scope()
+{
+	active_columns = previous;
+}
+
+
+
 //### XmlElementWriter ###
 
+namespace {
+
+/// The number of characters collected before writing coordinates text.
+constexpr std::size_t coord_chunk_size = 4096;
+
+}  // namespace
+
+
+
 void XmlElementWriter::write(const MapCoordVector& coords)
 {
 	namespace literal = XmlStreamLiteral;
 	
 	writeAttribute(literal::count, coords.size());
 	
-	if (XMLFileFormat::active_version < 6 || xml.autoFormatting())
+	if (auto* columns = XmlCoordColumns::active())
+	{
+		// Binary container: coordinates are stored in a separate section
+		writeAttribute(literal::first, columns->append(coords));
+	}
+	else if (XMLFileFormat::active_version < 6 || xml.autoFormatting())
 	{
 		// XMAP files and old format: syntactically rich output
 		for (auto& coord : coords)
@@ -177,17 +234,41 @@ void XmlElementWriter::write(const MapCoordVector& coords)
 		// Default: efficient plain text format
 		// Direct UTF-8 writing without unnecessary allocations, escaping or
 		// conversions, but also without handling of device errors.
+		// The coordinates are collected in chunks to reduce the number of
+		// device writes.
 		xml.writeCharacters({});  // Finish the start element
 		MapCoord::StringBuffer<char> buffer;
+		std::array<char, coord_chunk_size> chunk;
+		auto* out = chunk.data();
 		for (auto& coord : coords)
-			device->write(coord.toUtf8(buffer));
+		{
+			if (std::size_t(chunk.data() + chunk.size() - out) < buffer.size())
+			{
+				device->write(chunk.data(), out - chunk.data());
+				out = chunk.data();
+			}
+			auto const utf8 = coord.toUtf8(buffer);
+			out = std::copy(utf8.begin(), utf8.end(), out);
+		}
+		device->write(chunk.data(), out - chunk.data());
 	}
 	else
 	{
 		// Default: efficient plain text format
 		MapCoord::StringBuffer<QChar> buffer;
+		std::array<QChar, coord_chunk_size> chunk;
+		auto* out = chunk.data();
 		for (auto& coord : coords)
-			xml.writeCharacters(coord.toString(buffer));
+		{
+			if (std::size_t(chunk.data() + chunk.size() - out) < buffer.size())
+			{
+				xml.writeCharacters(QString::fromRawData(chunk.data(), out - chunk.data()));
+				out = chunk.data();
+			}
+			auto const text = coord.toString(buffer);
+			out = std::copy(text.begin(), text.end(), out);
+		}
+		xml.writeCharacters(QString::fromRawData(chunk.data(), out - chunk.data()));
 	}
 }
 
@@ -214,6 +295,23 @@ void XmlElementReader::read(MapCoordVector& coords)
 	coords.clear();
 	
 	const auto num_coords = attribute<unsigned int>(literal::count);
+	auto const* columns = XmlCoordColumns::active();
+	if (columns && hasAttribute(literal::first))
+	{
+		auto const first = attribute<long unsigned int>(literal::first);
+		if (first > columns->size() || columns->size() - first < num_coords)
+			throw FileFormatException(::LibreMapper::ImportExport::tr("Could not parse the coordinates."));
+		try
+		{
+			MapCoord::appendFromNative(columns->x() + first, columns->y() + first, columns->flags() + first, num_coords, coords);
+		}
+		catch (std::range_error &e)
+		{
+			throw FileFormatException(::LibreMapper::MapCoord::tr(e.what()));
+		}
+		return;
+	}
+	
 	coords.reserve(std::min(num_coords, 500000u));
 	
 	try
@@ -227,19 +325,9 @@ void XmlElementReader::read(MapCoordVector& coords)
 			}
 			else if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
 			{
-				QStringView text = xml.text();
 				try
 				{
-					/* \fixme Please mind that the text snippet (QStringView)
-					 * is modified by the MapCoord constructor. The loop tests
-					 * whether the constructor consumed all the charasters in 
-					 * the view. I (Libor) see this as an example violation of
-					 * the principle of least surprise.
-					 */
-					while (text.length())
-					{
-						coords.emplace_back(text);
-					}
+					MapCoord::appendFromString(xml.text(), coords);
 				}
 				catch (std::exception& e)
 				{
@@ -285,6 +373,32 @@ void XmlElementReader::readForText(MapCoordVector& coords)
 	
 	QScopedValueRollback<MapCoord::BoundsOffset> offset{MapCoord::boundsOffset()};
 	
+	auto const* columns = XmlCoordColumns::active();
+	if (columns && hasAttribute(literal::first))
+	{
+		auto const first = attribute<long unsigned int>(literal::first);
+		if (first > columns->size() || columns->size() - first < num_coords)
+			throw FileFormatException(::LibreMapper::ImportExport::tr("Could not parse the coordinates."));
+		try
+		{
+			for (auto i = first; i < first + num_coords; ++i)
+			{
+				if (coords.size() == 1)
+				{
+					// Don't apply an offset to text box size.
+					offset.commit();
+					MapCoord::boundsOffset().reset(false);
+				}
+				MapCoord::appendFromNative(columns->x() + i, columns->y() + i, columns->flags() + i, 1, coords);
+			}
+		}
+		catch (std::range_error &e)
+		{
+			throw FileFormatException(::LibreMapper::MapCoord::tr(e.what()));
+		}
+		return;
+	}
+	
 	try
 	{
 		for( xml.readNext(); xml.tokenType() != QXmlStreamReader::EndElement; xml.readNext() )
@@ -8,6 +8,9 @@
 #ifndef LIBREMAPPER_XML_STREAM_UTIL_H
 #define LIBREMAPPER_XML_STREAM_UTIL_H
 
+#include <cstddef>
+#include <vector>
+
 #include <QtGlobal>
 #include <QLatin1String>
 #include <QRectF>
@@ -96,6 +99,85 @@ private:
 };
 
 
+/**
+ * Columns of native coordinates which are stored outside of the XML text.
+ * 
+ * While an instance is active(), XmlElementWriter::write(const MapCoordVector&)
+ * appends the coordinates to the columns and writes only the index of the
+ * first one. XmlElementReader reads such coordinates back from the columns.
+ * This is used by container formats which keep the XML document and the
+ * coordinates in separate binary sections.
+ * 
+ * Columns are activated per thread, by means of an XmlCoordColumns::Scope.
+ */
+class XmlCoordColumns
+{
+public:
+	/**
+	 * Makes the given columns active in the current thread, for the
+	 * lifetime of the scope object.
+	 * 
+	 * The previously active columns are restored on destruction.
+	 */
+	class Scope
+	{
+	public:
+		explicit Scope(XmlCoordColumns& columns) noexcept;
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+		
+	private:
+		XmlCoordColumns* const previous;
+	};
+	
+	/**
+	 * Constructs empty columns for writing.
+	 */
+	XmlCoordColumns() = default;
+	
+	/**
+	 * Constructs columns for reading, referencing the given external data.
+	 */
+	XmlCoordColumns(const qint32* x, const qint32* y, const quint8* flags, std::size_t size) noexcept;
+	
+	XmlCoordColumns(const XmlCoordColumns&) = delete;
+	XmlCoordColumns& operator=(const XmlCoordColumns&) = delete;
+	
+	
+	std::size_t size() const noexcept { return size_; }
+	
+	const qint32* x() const noexcept { return x_data ? x_data : x_column.data(); }
+	
+	const qint32* y() const noexcept { return y_data ? y_data : y_column.data(); }
+	
+	const quint8* flags() const noexcept { return flags_data ? flags_data : flags_column.data(); }
+	
+	/**
+	 * Appends the coordinates and returns the index of the first one.
+	 */
+	std::size_t append(const MapCoordVector& coords);
+	
+	
+	/**
+	 * Returns the columns used for the XML document which is currently
+	 * written or read in the current thread, or nullptr.
+	 */
+	static XmlCoordColumns* active() noexcept { return active_columns; }
+	
+private:
+	static thread_local XmlCoordColumns* active_columns;
+	
+	std::vector<qint32> x_column;
+	std::vector<qint32> y_column;
+	std::vector<quint8> flags_column;
+	const qint32* x_data = nullptr;
+	const qint32* y_data = nullptr;
+	const quint8* flags_data = nullptr;
+	std::size_t size_ = 0;
+};
+
+
 
 /**
  * The XmlElementWriter helps to construct a single element in an XML document.
@@ -413,6 +495,7 @@ namespace XmlStreamLiteral
 	static const QLatin1String height("height");
 	
 	static const QLatin1String count("count");
+	static const QLatin1String first("first");
 	
 	static const QLatin1String object("object");
 	static const QLatin1String t("t");
@@ -8,6 +8,7 @@
 #include "coord_xml_t.h"
 
 #include <algorithm>
+#include <exception>
 
 #include <QtTest>
 
@@ -1049,6 +1050,49 @@ void CoordXmlTest::readFastImplementation()
 }
 
 
+void CoordXmlTest::appendFromString_data()
+{
+	QTest::addColumn<QString>("text");
+	QTest::addColumn<bool>("valid");
+	QTest::addColumn<int>("num_coords");
+	
+	QTest::newRow("empty")       << QStringLiteral("") << true << 0;
+	QTest::newRow("single")      << QStringLiteral("12345 -6789 32;") << true << 1;
+	QTest::newRow("no flags")    << QStringLiteral("12345 -6789;-1 1;") << true << 2;
+	QTest::newRow("line breaks") << QStringLiteral("\n12345 -6789 32;\r\n-1  1;\n") << true << 2;
+	QTest::newRow("long digits") << QStringLiteral("1234567890 -1234567890;") << true << 1;
+	QTest::newRow("no y")        << QStringLiteral("12345;") << false << 0;
+	QTest::newRow("no ;")        << QStringLiteral("12345 -6789") << false << 0;
+	QTest::newRow("bad char")    << QStringLiteral("12345 x;") << false << 0;
+	QTest::newRow("neg. flags")  << QStringLiteral("12345 -6789 -32;") << false << 0;
+}
+
+void CoordXmlTest::appendFromString()
+{
+	QFETCH(QString, text);
+	QFETCH(bool, valid);
+	QFETCH(int, num_coords);
+	
+	MapCoordVector coords;
+	if (!valid)
+	{
+		QVERIFY_THROWS_EXCEPTION(std::exception, MapCoord::appendFromString(text, coords));
+		return;
+	}
+	
+	MapCoord::appendFromString(text, coords);
+	QCOMPARE(int(coords.size()), num_coords);
+	
+	// Compare with the single coordinate parser.
+	QStringView view = text;
+	while (!view.isEmpty() && view.front().isSpace())
+		view = view.mid(1);
+	for (auto const& coord : coords)
+		QCOMPARE(coord, MapCoord(view));
+	QVERIFY(view.isEmpty());
+}
+
+
 bool CoordXmlTest::compare_all(MapCoordVector& coords, MapCoord& expected) const
 {
 	return std::all_of(begin(coords), end(coords), [expected](const MapCoord& coord){ return coord == expected; });
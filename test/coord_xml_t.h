@@ -70,6 +70,10 @@ private slots:
 	void readFastImplementation();
 	void readFastImplementation_data();
 	
+	/** Tests the bulk parser with different whitespace, signs and flags. */
+	void appendFromString();
+	void appendFromString_data();
+	
 private:
 	/** The common test data setup. */
 	void common_data();
@@ -64,6 +64,7 @@
 #include "core/symbols/line_symbol.h"
 #include "core/symbols/symbol.h"
 #include "core/symbols/text_symbol.h"
+#include "fileformats/binary_file_format.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_format_registry.h"
 #include "fileformats/file_import_export.h"
@@ -80,8 +81,11 @@
 #include "templates/template.h"
 #include "undo/undo.h"
 #include "undo/undo_manager.h"
+#include "util/gzip_device.h"
 
 #ifdef MAPPER_USE_GDAL
+#  include <gdal.h>
+#  include <ogr_api.h>
 #  include "gdal/gdal_manager.h"
 #endif
 
@@ -568,6 +572,10 @@ void FileFormatTest::initTestCase()
 	QVERIFY2(QDir::home().exists(), "The home dir must be writable in order to use QSettings.");
 	
 	doStaticInitializations();
+#ifndef MAPPER_BIG_ENDIAN
+	// Not registered by default, while the layout is not final.
+	FileFormats.registerFormat(new BinaryFileFormat());
+#endif
 	
 	const auto prefix = QString::fromLatin1("data");
 	QDir::addSearchPath(prefix, QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(prefix));
@@ -681,10 +689,20 @@ void FileFormatTest::understandsTest_data()
 	quint8 ocd_start_raw[2] = { 0xAD, 0x0C };
 	auto ocd_start   = QByteArray::fromRawData(reinterpret_cast<const char*>(ocd_start_raw), 2).append("random data");
 	auto omap_start  = QByteArray("OMAP plus random data");
+	auto binary_start = QByteArray("\x89LMB\r\n\x1a\n plus random data");
 	auto xml_start   = QByteArray("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
 	auto xml_legacy  = QByteArray(xml_start + "\r\n<map xmlns=\"http://oorienteering.sourceforge.net/mapper/xml/v2\">");
 	auto xml_regular = QByteArray(xml_start + "\n<map xmlns=\"http://openorienteering.org/apps/mapper/xml/v2\" version=\"7\">");
 	auto xml_gpx     = QByteArray(xml_start + "\n<gpx>");
+	auto gzip = [](const QByteArray& data) {
+		QBuffer buffer;
+		buffer.open(QIODevice::WriteOnly);
+		GzipCompressingDevice compressed(buffer);
+		compressed.open(QIODevice::WriteOnly);
+		compressed.write(data);
+		compressed.close();
+		return buffer.data();
+	};
 	
 	// Add all file formats which support import and export
 	QTest::addColumn<QByteArray>("format_id");
@@ -700,6 +718,12 @@ void FileFormatTest::understandsTest_data()
 	QTest::newRow("XML < xml other")        << QByteArray("XML") << xml_gpx           << int(FileFormat::NotSupported);
 	QTest::newRow("XML < 'OMAPxxx'")        << QByteArray("XML") << omap_start        << int(FileFormat::FullySupported);
 	QTest::newRow("XML < 0x0CADxxx")        << QByteArray("XML") << ocd_start         << int(FileFormat::NotSupported);
+	QTest::newRow("XML < gzip regular")     << QByteArray("XML") << gzip(xml_regular) << int(FileFormat::NotSupported);
+	
+	QTest::newRow("XML-gz < gzip regular")  << QByteArray("XML-gz") << gzip(xml_regular) << int(FileFormat::FullySupported);
+	QTest::newRow("XML-gz < gzip other")    << QByteArray("XML-gz") << gzip(xml_gpx)     << int(FileFormat::NotSupported);
+	QTest::newRow("XML-gz < gzip incomplete") << QByteArray("XML-gz") << gzip(xml_regular).left(12) << int(FileFormat::Unknown);
+	QTest::newRow("XML-gz < xml regular")   << QByteArray("XML-gz") << xml_regular       << int(FileFormat::NotSupported);
 	
 	QTest::newRow("OCD < 0x0CADxxx")        << QByteArray("OCD") << ocd_start         << int(FileFormat::FullySupported);
 	QTest::newRow("OCD < 0x0CAD")           << QByteArray("OCD") << ocd_start.left(2) << int(FileFormat::FullySupported);
@@ -708,6 +732,13 @@ void FileFormatTest::understandsTest_data()
 	QTest::newRow("OCD < 'OMAPxxx'")        << QByteArray("OCD") << omap_start        << int(FileFormat::NotSupported);
 	QTest::newRow("OCD < xml start")        << QByteArray("OCD") << xml_start         << int(FileFormat::NotSupported);
 	
+#ifndef MAPPER_BIG_ENDIAN
+	QTest::newRow("Binary < binary start")  << QByteArray("Binary") << binary_start   << int(FileFormat::FullySupported);
+	QTest::newRow("Binary < 'OMAPxxx'")     << QByteArray("Binary") << omap_start     << int(FileFormat::NotSupported);
+	QTest::newRow("Binary < xml start")     << QByteArray("Binary") << xml_start      << int(FileFormat::NotSupported);
+	QTest::newRow("XML < binary start")     << QByteArray("XML") << binary_start      << int(FileFormat::NotSupported);
+#endif
+	
 	/// \todo Test OgrFileFormat (ID "OGR")
 }
 
@@ -849,7 +880,9 @@ void FileFormatTest::saveAndLoad_data()
 	// Add all file formats which support import and export
 	static const auto format_ids = {
 	    "XML",
+	    "XML-gz",
 #ifndef MAPPER_BIG_ENDIAN
+	    "Binary",
 	    "OCD",
 #endif
 	};
@@ -1061,6 +1094,85 @@ void FileFormatTest::ogrExportTest()
 }
 
 
+void FileFormatTest::gpkgExportTest()
+{
+#ifdef MAPPER_USE_GDAL
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	// The layer names are derived from the file name. The quote must be
+	// escaped in the SQL statements for the spatial index.
+	auto const gpkg_filepath = QString {dir.path() + QLatin1String("/ogr'export.gpkg")};
+	
+	// More point objects than fit into a single transaction
+	constexpr int num_extra_points = 100500;
+	
+	int num_points = 0;
+	{
+		Map map;
+		QVERIFY(map.loadFrom(QString::fromLatin1("data:/examples/complete map.omap")));
+		
+		auto is_exported_point = [](const Symbol* symbol) {
+			return symbol->getType() == Symbol::Point && !symbol->isHidden() && !symbol->isHelperSymbol();
+		};
+		const Symbol* point_symbol = nullptr;
+		for (int i = 0; i < map.getNumSymbols() && !point_symbol; ++i)
+		{
+			if (is_exported_point(map.getSymbol(i)))
+				point_symbol = map.getSymbol(i);
+		}
+		QVERIFY(point_symbol);
+		
+		auto* part = map.getPart(0);
+		for (int i = 0; i < num_extra_points; ++i)
+		{
+			auto* object = new PointObject(point_symbol);
+			object->setPosition(MapCoord(i % 1000, i / 1000));
+			part->addObject(object);
+		}
+		map.applyOnAllObjects([&](const Object* object) {
+			if (is_exported_point(object->getSymbol()))
+				++num_points;
+		});
+		
+		auto const* format = FileFormats.findFormat("OGR-export-GPKG");
+		QVERIFY(format);
+		
+		auto exporter = format->makeExporter(gpkg_filepath, &map, nullptr);
+		QVERIFY(bool(exporter));
+		QVERIFY(exporter->doExport());
+	}
+	QVERIFY(num_points > num_extra_points);
+	
+	auto* dataset = GDALOpenEx(gpkg_filepath.toUtf8().constData(), GDAL_OF_VECTOR | GDAL_OF_READONLY, nullptr, nullptr, nullptr);
+	QVERIFY(dataset);
+	
+	auto* points_layer = GDALDatasetGetLayerByName(dataset, "ogr'export_points");
+	QVERIFY(points_layer);
+	QCOMPARE(OGR_L_GetFeatureCount(points_layer, 1), GIntBig(num_points));
+	
+	// All layers must have got their deferred spatial index.
+	QVERIFY(GDALDatasetGetLayerCount(dataset) > 0);
+	for (int i = 0; i < GDALDatasetGetLayerCount(dataset); ++i)
+	{
+		auto* layer = GDALDatasetGetLayer(dataset, i);
+		QVERIFY(QByteArray(OGR_L_GetName(layer)).startsWith("ogr'export_"));
+		QByteArray const sql = QByteArray("SELECT HasSpatialIndex('")
+		                       + QByteArray(OGR_L_GetName(layer)).replace('\'', "''") + "', '"
+		                       + OGR_L_GetGeometryColumn(layer) + "')";
+		auto* result = GDALDatasetExecuteSQL(dataset, sql.constData(), nullptr, nullptr);
+		QVERIFY(result);
+		auto* feature = OGR_L_GetNextFeature(result);
+		auto const has_spatial_index = feature && OGR_F_GetFieldAsInteger(feature, 0) == 1;
+		OGR_F_Destroy(feature);
+		GDALDatasetReleaseResultSet(dataset, result);
+		QVERIFY2(has_spatial_index, OGR_L_GetName(layer));
+	}
+	
+	GDALClose(dataset);
+#endif  // MAPPER_USE_GDAL
+}
+
+
 void FileFormatTest::kmlCourseExportTest()
 {
 	QTemporaryDir dir;
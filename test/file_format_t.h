@@ -82,6 +82,12 @@ private slots:
 	void ogrExportTest();
 	void ogrExportTest_data();
 	
+	/**
+	 * Tests GeoPackage export with multiple transactions and deferred
+	 * spatial indexes.
+	 */
+	void gpkgExportTest();
+	
 	/**
 	 * Tests the export of KML courses.
 	 */
@@ -7,22 +7,31 @@
 
 #include "map_t.h"
 
+#include <cstddef>
+#include <vector>
+
 #include <QtTest>
 #include <QBuffer>
+#include <QFile>
 #include <QMessageBox>
+#include <QTemporaryDir>
 #include <QTextStream>
 
 #include "test_config.h"
 
 #include "global.h"
+#include "core/autosave_journal.h"
 #include "core/map.h"
 #include "core/map_color.h"
+#include "core/map_part.h"
 #include "core/map_printer.h" // IWYU pragma: keep
 #include "core/map_view.h"
 #include "core/objects/object.h"
 #include "core/objects/symbol_rule_set.h"
 #include "core/symbols/symbol.h"
 #include "core/symbols/point_symbol.h"
+#include "undo/object_undo.h"
+#include "undo/undo_manager.h"
 
 using namespace LibreMapper;
 
@@ -208,6 +217,246 @@ void MapTest::importTest()
 }
 
 
+void MapTest::autosaveJournalTest()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const checkpoint_path = dir.filePath(QStringLiteral("journal.omap"));
+	
+	Map map;
+	MapView view{ &map };
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("forest sample.omap")), &view));
+	auto* part = map.getCurrentPart();
+	QVERIFY(part->getNumObjects() > 3);
+	
+	AutosaveJournal journal(map, checkpoint_path);
+	QVERIFY(journal.needsCheckpoint());
+	{
+		QFile checkpoint(checkpoint_path);
+		QVERIFY(checkpoint.open(QIODevice::WriteOnly));
+		QVERIFY(map.exportToIODevice(checkpoint));
+	}
+	QVERIFY(journal.checkpointWritten());
+	QVERIFY(!journal.needsCheckpoint());
+	
+	// Delete the first object, and add a copy of the second one at the end.
+	auto* add_step = new AddObjectsUndoStep(&map);
+	add_step->addObject(0, part->releaseObject(0));
+	map.push(add_step);
+	part->addObject(part->getObject(1)->duplicate());
+	auto* delete_step = new DeleteObjectsUndoStep(&map);
+	delete_step->addObject(part->getNumObjects() - 1);
+	map.push(delete_step);
+	QVERIFY(journal.append());
+	
+	// Modify an object in place, and undo the deletion in a second step.
+	auto* replace_step = new ReplaceObjectsUndoStep(&map);
+	replace_step->addObject(2, part->getObject(2)->duplicate());
+	part->getObject(2)->move(1000, 1000);
+	map.push(replace_step);
+	QVERIFY(map.undoManager().undo());
+	QVERIFY(map.undoManager().undo());
+	QVERIFY(!journal.needsCheckpoint());
+	QVERIFY(journal.append());
+	
+	Map recovered;
+	QVERIFY(recovered.loadFrom(checkpoint_path));
+	QVERIFY(AutosaveJournal::replay(recovered, checkpoint_path));
+	QCOMPARE(recovered.getNumParts(), map.getNumParts());
+	for (int i = 0; i < map.getNumParts(); ++i)
+	{
+		auto const* expected = map.getPart(std::size_t(i));
+		auto const* actual = recovered.getPart(std::size_t(i));
+		QCOMPARE(actual->getNumObjects(), expected->getNumObjects());
+		for (int j = 0; j < expected->getNumObjects(); ++j)
+			QVERIFY(actual->getObject(j)->equals(expected->getObject(j), false));
+	}
+	
+	// A journal is ignored for a different checkpoint, even if the size and
+	// the modification time of the checkpoint are unchanged.
+	Map reference;
+	QVERIFY(reference.loadFrom(checkpoint_path));
+	Map ignored;
+	QVERIFY(ignored.loadFrom(checkpoint_path));
+	{
+		QFile checkpoint(checkpoint_path);
+		QVERIFY(checkpoint.open(QIODevice::ReadWrite));
+		auto const modified = checkpoint.fileTime(QFileDevice::FileModificationTime);
+		auto data = checkpoint.readAll();
+		auto const newline = data.indexOf('\n');
+		QVERIFY(newline > 0);
+		data[newline] = ' ';
+		QVERIFY(checkpoint.seek(0));
+		QCOMPARE(checkpoint.write(data), data.size());
+		QVERIFY(checkpoint.flush());
+		QVERIFY(checkpoint.setFileTime(modified, QFileDevice::FileModificationTime));
+	}
+	QVERIFY(!journal.needsCheckpoint());
+	QVERIFY(AutosaveJournal::replay(ignored, checkpoint_path));
+	for (int i = 0; i < reference.getNumParts(); ++i)
+	{
+		auto const* expected = reference.getPart(std::size_t(i));
+		auto const* actual = ignored.getPart(std::size_t(i));
+		QCOMPARE(actual->getNumObjects(), expected->getNumObjects());
+		for (int j = 0; j < expected->getNumObjects(); ++j)
+			QVERIFY(actual->getObject(j)->equals(expected->getObject(j), false));
+	}
+	
+	// A new checkpoint invalidates the journal.
+	{
+		QFile checkpoint(checkpoint_path);
+		QVERIFY(checkpoint.open(QIODevice::WriteOnly | QIODevice::Append));
+		QVERIFY(checkpoint.write("\n") == 1);
+	}
+	QVERIFY(journal.needsCheckpoint());
+}
+
+
+
+void MapTest::objectIndexTest()
+{
+	Map map;
+	auto* part = map.getCurrentPart();
+	std::vector<Object*> objects;
+	for (int i = 0; i < 10; ++i)
+	{
+		objects.push_back(new PointObject(Map::getUndefinedPoint()));
+		part->addObject(objects.back());
+	}
+	for (int i = 0; i < 10; ++i)
+		QCOMPARE(part->findObjectIndex(objects[std::size_t(i)]), i);
+	
+	// Insertion and removal move the following objects.
+	auto* inserted = new PointObject(Map::getUndefinedPoint());
+	part->addObject(inserted, 3);
+	QCOMPARE(part->findObjectIndex(inserted), 3);
+	QCOMPARE(part->findObjectIndex(objects[2]), 2);
+	QCOMPARE(part->findObjectIndex(objects[3]), 4);
+	QCOMPARE(part->findObjectIndex(objects[9]), 10);
+	
+	QCOMPARE(part->releaseObject(objects[1]), objects[1]);
+	QVERIFY(!part->contains(objects[1]));
+	QCOMPARE(part->findObjectIndex(objects[0]), 0);
+	QCOMPARE(part->findObjectIndex(inserted), 2);
+	QCOMPARE(part->findObjectIndex(objects[9]), 9);
+	QVERIFY(!part->releaseObject(objects[1]));
+	
+	// A replaced object is no longer found.
+	part->setObject(objects[1], 5, false);
+	QCOMPARE(part->findObjectIndex(objects[1]), 5);
+	QVERIFY(!part->contains(objects[5]));
+	delete objects[5];
+	
+	for (int i = 0; i < part->getNumObjects(); ++i)
+		QCOMPARE(part->findObjectIndex(part->getObject(i)), i);
+	
+	// Batch operations keep the indices exact, too.
+	auto released = part->releaseObjects({ 0, 2, 4 });
+	QCOMPARE(released.size(), std::size_t(3));
+	for (auto* object : released)
+		QVERIFY(!part->contains(object));
+	for (int i = 0; i < part->getNumObjects(); ++i)
+		QCOMPARE(part->findObjectIndex(part->getObject(i)), i);
+	
+	part->addObjects({ { 1, released[0] }, { 3, released[1] } });
+	QCOMPARE(part->findObjectIndex(released[0]), 1);
+	QCOMPARE(part->findObjectIndex(released[1]), 3);
+	QVERIFY(!part->contains(released[2]));
+	delete released[2];
+	for (int i = 0; i < part->getNumObjects(); ++i)
+		QCOMPARE(part->findObjectIndex(part->getObject(i)), i);
+}
+
+
+
+void MapTest::batchObjectsTest()
+{
+	Map map;
+	auto* part = map.getCurrentPart();
+	std::vector<Object*> objects;
+	for (int i = 0; i < 10; ++i)
+	{
+		objects.push_back(new PointObject(Map::getUndefinedPoint()));
+		part->addObject(objects.back());
+	}
+	
+	auto const released = part->releaseObjects({ 7, 0, 3, 9, 3 });
+	QCOMPARE(int(released.size()), 4);
+	QCOMPARE(released[0], objects[0]);
+	QCOMPARE(released[1], objects[3]);
+	QCOMPARE(released[2], objects[7]);
+	QCOMPARE(released[3], objects[9]);
+	QCOMPARE(part->getNumObjects(), 6);
+	QCOMPARE(part->getObject(0), objects[1]);
+	QCOMPARE(part->getObject(2), objects[4]);
+	QCOMPARE(part->getObject(5), objects[8]);
+	
+	// Restoring the former indices restores the original order.
+	part->addObjects({ { 9, released[3] }, { 3, released[1] }, { 0, released[0] }, { 7, released[2] } });
+	QCOMPARE(part->getNumObjects(), 10);
+	for (int i = 0; i < 10; ++i)
+		QCOMPARE(part->getObject(i), objects[std::size_t(i)]);
+	
+	// Undo steps use the same functions.
+	auto* delete_step = new DeleteObjectsUndoStep(&map);
+	delete_step->addObject(2);
+	delete_step->addObject(5);
+	map.push(delete_step);
+	map.undoManager().undo();
+	QCOMPARE(part->getNumObjects(), 8);
+	QVERIFY(!part->contains(objects[2]));
+	QVERIFY(!part->contains(objects[5]));
+	map.undoManager().redo();
+	QCOMPARE(part->getNumObjects(), 10);
+	for (int i = 0; i < 10; ++i)
+		QCOMPARE(part->getObject(i), objects[std::size_t(i)]);
+}
+
+
+
+void MapTest::selectionTest()
+{
+	Map map;
+	auto* part = map.getCurrentPart();
+	for (int i = 0; i < 10; ++i)
+	{
+		if (i % 2)
+			part->addObject(new PathObject(Map::getUndefinedLine()));
+		else
+			part->addObject(new PointObject(Map::getUndefinedPoint()));
+	}
+	
+	for (int i = 0; i < 10; ++i)
+		map.addObjectToSelection(part->getObject(i), false);
+	QCOMPARE(map.getNumSelectedObjects(), 10);
+	QCOMPARE(map.getFirstSelectedObject(), part->getObject(0));
+	QVERIFY(map.isObjectSelected(part->getObject(9)));
+	
+	map.removeObjectFromSelection(part->getObject(0), false);
+	QCOMPARE(map.getNumSelectedObjects(), 9);
+	QVERIFY(!map.isObjectSelected(part->getObject(0)));
+	QVERIFY(map.getFirstSelectedObject());
+	QVERIFY(map.getFirstSelectedObject() != part->getObject(0));
+	
+	QVERIFY(map.removeSymbolFromSelection(Map::getUndefinedLine(), false));
+	QCOMPARE(map.getNumSelectedObjects(), 4);
+	for (auto const* object : map.selectedObjects())
+		QCOMPARE(object->getSymbol(), Map::getUndefinedPoint());
+	QVERIFY(!map.removeSymbolFromSelection(Map::getUndefinedLine(), false));
+	
+	// A copy is independent from the map's selection.
+	auto selection = map.selectedObjects();
+	QVERIFY(map.toggleObjectSelection(part->getObject(1), false));
+	QVERIFY(!selection.contains(part->getObject(1)));
+	QVERIFY(selection.find(part->getObject(2)) != selection.end());
+	
+	map.clearObjectSelection(false);
+	QCOMPARE(map.getNumSelectedObjects(), 0);
+	QVERIFY(!map.getFirstSelectedObject());
+	QCOMPARE(int(selection.size()), 4);
+}
+
+
 
 void MapTest::hasAlpha()
 {
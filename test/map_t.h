@@ -36,6 +36,18 @@ private slots:
 	void importTest_data();
 	void importTest();
 	
+	/** Tests recovery of object changes from the autosave journal. */
+	void autosaveJournalTest();
+	
+	/** Tests the lookup of object indices in map parts. */
+	void objectIndexTest();
+	
+	/** Tests adding and releasing multiple objects at once. */
+	void batchObjectsTest();
+	
+	/** Tests the object selection. */
+	void selectionTest();
+	
 	/** Tests hasAlpha() functions. */
 	void hasAlpha();
 	
@@ -8,6 +8,8 @@
 
 #include "path_object_t.h"
 
+#include <random>
+
 #include <QtTest>
 
 #include "core/map.h"
@@ -1092,6 +1094,62 @@ void PathObjectTest::calcIntersectionsTest()
 
 
 
+void PathObjectTest::calcIntersectionsPruningTest()
+{
+	// Random paths on a coarse grid, with many collinear overlaps
+	std::mt19937 random(1);
+	auto random_path = [&random](int num_parts) {
+		MapCoordVector coords;
+		for (int part = 0; part < num_parts; ++part)
+		{
+			auto const first = coords.size();
+			auto const num_coords = 2 + int(random() % 40);
+			auto x = qreal(random() % 20);
+			auto y = qreal(random() % 20);
+			for (int i = 0; i < num_coords; ++i)
+			{
+				coords.emplace_back(x, y);
+				switch (random() % 4)
+				{
+				case 0:
+					x += int(random() % 5) - 2;
+					break;
+				case 1:
+					y += int(random() % 5) - 2;
+					break;
+				default:
+					x += 0.5 * (int(random() % 5) - 2);
+					y += 0.5 * (int(random() % 5) - 2);
+				}
+			}
+			if (random() % 2)
+			{
+				coords.push_back(coords[first]);
+				coords.back().setClosePoint(true);
+			}
+			coords.back().setHolePoint(true);
+		}
+		return PathObject{Map::getCoveringRedLine(), coords};
+	};
+	
+	for (int i = 0; i < 2000; ++i)
+	{
+		// The paths have the same number of parts,
+		// cf. the FIXME in calcAllIntersectionsWith().
+		auto const num_parts = 1 + int(random() % 3);
+		auto const path1 = random_path(num_parts);
+		auto const path2 = random_path(num_parts);
+		
+		PathObject::Intersections exhaustive;
+		path1.calcAllIntersectionsWith(&path2, exhaustive, false);
+		PathObject::Intersections pruned;
+		path1.calcAllIntersectionsWith(&path2, pruned, true);
+		QCOMPARE(pruned, exhaustive);
+	}
+}
+
+
+
 void PathObjectTest::atypicalPathTest()
 {
 	// This is a zero-length closed path of three arcs.
@@ -1195,6 +1253,116 @@ void PathObjectTest::recalculatePartsTest()
 }
 
 
+void PathObjectTest::simplifyPolygonalTest()
+{
+	{
+		// An open line with small deviations and a spike
+		PathObject line{Map::getCoveringRedLine()};
+		for (auto const& coord : { MapCoord(0, 0), MapCoord(10, 0.05), MapCoord(20, 0), MapCoord(30, 5),
+		                           MapCoord(40, 0), MapCoord(50, -0.05), MapCoord(60, 0) })
+			line.addCoordinate(coord);
+		
+		PathObject* undo_duplicate = nullptr;
+		QVERIFY(line.simplify(&undo_duplicate, 0.1));
+		QVERIFY(undo_duplicate);
+		QCOMPARE(undo_duplicate->getCoordinateCount(), std::size_t(7));
+		delete undo_duplicate;
+		
+		auto const expected = MapCoordVector { MapCoord(0, 0), MapCoord(20, 0), MapCoord(30, 5), MapCoord(40, 0), MapCoord(60, 0) };
+		QCOMPARE(line.getCoordinateCount(), std::size_t(5));
+		for (std::size_t i = 0; i < expected.size(); ++i)
+			QVERIFY(line.getCoordinate(MapCoordVector::size_type(i)).isPositionEqualTo(expected[i]));
+		QVERIFY(line.getCoordinate(4).isHolePoint());
+		
+		// Nothing left to remove
+		QVERIFY(!line.simplify(nullptr, 0.1));
+	}
+	
+	{
+		// A closed square with extra nodes, starting in the middle of an edge
+		PathObject square{Map::getCoveringRedLine()};
+		for (auto const& coord : { MapCoord(0, 5), MapCoord(0, 0), MapCoord(5, 0), MapCoord(10, 0),
+		                           MapCoord(10, 10), MapCoord(5, 10), MapCoord(0, 10) })
+			square.addCoordinate(coord);
+		square.closeAllParts();
+		QCOMPARE(square.getCoordinateCount(), std::size_t(8));
+		
+		QVERIFY(square.simplify(nullptr, 0.1));
+		QCOMPARE(square.parts().size(), std::size_t(1));
+		QVERIFY(square.parts().front().isClosed());
+		QCOMPARE(square.getCoordinateCount(), std::size_t(5));
+		QCOMPARE(square.parts().front().countRegularNodes(), PathPart::size_type(4));
+		QVERIFY(square.getCoordinate(0).isPositionEqualTo(MapCoord(0, 0)));
+		QVERIFY(square.getCoordinate(4).isPositionEqualTo(MapCoord(0, 0)));
+		QVERIFY(square.getCoordinate(4).isClosePoint());
+	}
+}
+
+
+void PathObjectTest::incrementalUpdateTest()
+{
+	// Two parts: an open line with a curve, and a closed line.
+	MapCoordVector coords = {
+	    MapCoord(0, 0), MapCoord(10, 0), MapCoord(20, 5), MapCoord(20, 10), MapCoord(30, 20),
+	    MapCoord(40, 20), MapCoord(50, 30),
+	    MapCoord(0, 40), MapCoord(10, 40), MapCoord(10, 50), MapCoord(0, 40),
+	};
+	coords[1].setCurveStart(true);
+	coords[6].setHolePoint(true);
+	coords[10].setClosePoint(true);
+	coords[10].setHolePoint(true);
+	
+	PathObject path{Map::getCoveringRedLine(), coords};
+	path.update();
+	
+	auto compare_to_full_update = [](const PathObject& path) {
+		path.update();
+		PathObject copy{path};
+		copy.update();
+		QCOMPARE(path.parts().size(), copy.parts().size());
+		for (std::size_t i = 0; i < path.parts().size(); ++i)
+		{
+			auto const& actual = path.parts()[i].path_coords;
+			auto const& expected = copy.parts()[i].path_coords;
+			QCOMPARE(actual.size(), expected.size());
+			for (std::size_t j = 0; j < actual.size(); ++j)
+			{
+				QCOMPARE(actual[j].pos.x(), expected[j].pos.x());
+				QCOMPARE(actual[j].pos.y(), expected[j].pos.y());
+				QCOMPARE(actual[j].index, expected[j].index);
+				QCOMPARE(actual[j].param, expected[j].param);
+				QVERIFY(std::abs(actual[j].clen - expected[j].clen) < 0.001f);
+			}
+		}
+	};
+	
+	// Regular point before a curve
+	path.setCoordinate(1, MapCoord(10, 5));
+	compare_to_full_update(path);
+	
+	// Curve handle, and a later point
+	path.setCoordinate(3, MapCoord(25, 10));
+	path.setCoordinate(5, MapCoord(45, 20));
+	compare_to_full_update(path);
+	
+	// Start and end of the open part
+	path.setCoordinate(0, MapCoord(-5, 0));
+	path.setCoordinate(6, MapCoord(50, 35));
+	compare_to_full_update(path);
+	
+	// Start of the closed part
+	path.setCoordinate(7, MapCoord(0, 45));
+	compare_to_full_update(path);
+	QVERIFY(path.getCoordinate(10).isPositionEqualTo(MapCoord(0, 45)));
+	
+	// Mixed with a structural change
+	path.setCoordinate(8, MapCoord(15, 40));
+	path.deleteCoordinate(2, false);
+	path.setCoordinate(3, MapCoord(40, 25));
+	compare_to_full_update(path);
+}
+
+
 
 /*
  * We don't need a real GUI window.
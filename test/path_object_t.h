@@ -60,12 +60,21 @@ private slots:
 	/** Tests finding intersections with calcAllIntersectionsWith(). */
 	void calcIntersectionsTest();
 	
+	/** Compares calcAllIntersectionsWith() with and without segment pruning. */
+	void calcIntersectionsPruningTest();
+	
 	/** Tests PathCoord and SplitPathCoord for a non-trivial zero-length path. */
 	void atypicalPathTest();
 	
 	/** Tests recalculation of path parts from input coords. */
 	void recalculatePartsTest();
 	void recalculatePartsTest_data();
+	
+	/** Tests PathObject::simplify() for paths without curves. */
+	void simplifyPolygonalTest();
+	
+	/** Tests the incremental update of path coords after setCoordinate(). */
+	void incrementalUpdateTest();
 };
 
 #endif
@@ -5,6 +5,7 @@
  * This file is part of LibreMapper.
  */
 
+#include <cstddef>
 #include <initializer_list>
 #include <memory>
 
@@ -20,6 +21,7 @@
 #include <QLatin1String>
 #include <QObject>
 #include <QPainter>
+#include <QPen>
 #include <QPoint>
 #include <QRect>
 #include <QRectF>
@@ -31,7 +33,10 @@
 #include "test_config.h"
 #include "core/map.h"
 #include "core/map_color.h"
+#include "core/map_coord.h"
+#include "core/virtual_path.h"
 #include "core/renderables/renderable.h"
+#include "core/renderables/renderable_implementation.h"
 #include "core/symbols/area_symbol.h"
 #include "core/symbols/combined_symbol.h"
 #include "core/symbols/line_symbol.h"
@@ -375,6 +380,85 @@ private slots:
 		QVERIFY(clone->equals(&l));
 	}
 	
+	void lineRenderableChunksTest()
+	{
+		MapColor color;
+		LineSymbol l;
+		l.setColor(&color);
+		l.setLineWidth(1.0);
+		
+		auto make_line = [](int length) {
+			MapCoordVector coords;
+			for (int x = 0; x <= length; x += 10)
+				coords.emplace_back(qreal(x), 0.0);
+			return coords;
+		};
+		
+		auto long_line = make_line(1000);
+		auto extents = LineRenderable(&l, VirtualPath(long_line), false).chunkExtents();
+		QCOMPARE(extents.size(), std::size_t(10));
+		for (std::size_t i = 0; i < extents.size(); ++i)
+		{
+			// Neighbouring chunks share a vertex, and include the line width.
+			QCOMPARE(extents[i], QRectF(100.0 * i - 1, -1, 102, 2));
+		}
+		
+		auto short_line = make_line(200);
+		QVERIFY(LineRenderable(&l, VirtualPath(short_line), false).chunkExtents().empty());
+		
+		auto line_with_gap = long_line;
+		line_with_gap[50].setGapPoint(true);
+		line_with_gap[51].setGapPoint(true);
+		QVERIFY(LineRenderable(&l, VirtualPath(line_with_gap), false).chunkExtents().empty());
+		
+		auto line_with_hole = long_line;
+		line_with_hole[50].setHolePoint(true);
+		QVERIFY(LineRenderable(&l, VirtualPath(line_with_hole), false).chunkExtents().empty());
+		
+		// Culling by chunk extents
+		auto l_shape = long_line;
+		for (int y = 10; y <= 1000; y += 10)
+			l_shape.emplace_back(1000.0, qreal(y));
+		LineRenderable const l_renderable(&l, VirtualPath(l_shape), false);
+		QVERIFY(l_renderable.getExtent().intersects(QRectF(100, 500, 10, 10)));
+		QVERIFY(!l_renderable.intersects(QRectF(100, 500, 10, 10)));
+		QVERIFY(l_renderable.intersects(QRectF(500, -5, 10, 10)));
+		QVERIFY(l_renderable.intersects(QRectF(995, 500, 10, 10)));
+		
+		// Only closed lines are joined at the start point when drawing the
+		// visible chunks, even if an open line ends at its start point.
+		MapCoordVector loop;
+		for (int i = 0; i < 400; i += 10)
+			loop.emplace_back(qreal(i), 0.0);
+		for (int i = 0; i < 400; i += 10)
+			loop.emplace_back(400.0, qreal(i));
+		for (int i = 400; i > 0; i -= 10)
+			loop.emplace_back(qreal(i), 400.0);
+		for (int i = 400; i >= 0; i -= 10)
+			loop.emplace_back(0.0, qreal(i));
+		
+		l.setLineWidth(10.0);
+		l.setCapStyle(LineSymbol::FlatCap);
+		l.setJoinStyle(LineSymbol::RoundJoin);
+		auto render_start_corner = [&l, &loop](bool closed) {
+			LineRenderable const renderable(&l, VirtualPath(loop), closed);
+			if (renderable.chunkExtents().empty())
+				return QRgb(0);
+			
+			Map map;
+			QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+			image.fill(Qt::white);
+			QPainter painter(&image);
+			painter.translate(50, 50);
+			painter.setPen(QPen(Qt::black, 10));
+			renderable.render(painter, RenderConfig{map, QRectF(-50, -50, 100, 100), 1, {}, RenderConfig::DisableAntialiasing, 1});
+			painter.end();
+			return image.pixel(47, 47);  // outside of the flat caps at (0, 0)
+		};
+		QCOMPARE(render_start_corner(false), QColor(Qt::white).rgb());
+		QCOMPARE(render_start_corner(true), QColor(Qt::black).rgb());
+	}
+	
 	void CombinedSymbolTest()
 	{
 		CombinedSymbol c;
@@ -9,6 +9,7 @@
 #include <cmath>
 #include <iosfwd>
 #include <memory>
+#include <random>
 #include <vector>
 
 #include <Qt>
@@ -23,6 +24,7 @@
 #include <QFile>
 #include <QFileDevice>
 #include <QFileInfo>
+#include <QImage>
 #include <QImageWriter>
 #include <QIODevice>
 #include <QLineF>
@@ -31,6 +33,7 @@
 #include <QObject>
 #include <QPointF>
 #include <QRectF>
+#include <QRgb>
 #include <QSignalSpy>  // IWYU pragma: keep
 #include <QString>
 #include <QStringList>
@@ -59,6 +62,7 @@
 
 #ifdef MAPPER_USE_GDAL
 #  include "gdal/gdal_file.h"
+#  include "gdal/gdal_image_reader.h"
 #endif
 
 using namespace LibreMapper;
@@ -75,6 +79,17 @@ QPointF center(const Template* temp)
 	return temp->templateToMap(temp->getTemplateExtent().center());
 }
 
+#ifdef MAPPER_USE_GDAL
+
+/// Provides access to the pixel conversions of GdalImageReader.
+struct GdalImageReaderAccess : public GdalImageReader
+{
+	using GdalImageReader::premultiplyARGB32;
+	using GdalImageReader::premultiplyGray8;
+};
+
+#endif
+
 }  // namespace
 
 
@@ -148,6 +163,62 @@ private slots:
 		resolved_path = GdalFile::tryToFindRelativeTemplateFile("../doc.kml_xy", vsizip + "/files/1.jpg");
 		QVERIFY(resolved_path.isEmpty());
 	}
+	
+	void gdalPremultiplyTest_data()
+	{
+		QTest::addColumn<int>("width");
+		QTest::addColumn<int>("height");
+		
+		// Odd widths leave tails after the four pixel SIMD blocks.
+		for (auto width : { 1, 3, 4, 5, 7, 16, 33 })
+			QTest::addRow("%dx5", width) << width << 5;
+		// Large enough for multiple bands of rows.
+		QTest::newRow("1201x1000") << 1201 << 1000;
+	}
+	
+	void gdalPremultiplyTest()
+	{
+		QFETCH(int, width);
+		QFETCH(int, height);
+		
+		auto random = std::mt19937{ 1 };
+		auto byte = std::uniform_int_distribution<int>{ 0, 255 };
+		QImage original(width, height, QImage::Format_ARGB32);
+		for (int y = 0; y < height; ++y)
+		{
+			auto* pixels = reinterpret_cast<QRgb*>(original.scanLine(y));
+			for (int x = 0; x < width; ++x)
+			{
+				auto alpha = byte(random);
+				// Cover the extreme values in every row.
+				if (x % 5 == 0)
+					alpha = 0;
+				else if (x % 5 == 1)
+					alpha = 255;
+				pixels[x] = qRgba(byte(random), byte(random), byte(random), alpha);
+			}
+		}
+		
+		auto argb32 = original.copy();
+		GdalImageReaderAccess::premultiplyARGB32(argb32);
+		auto gray8 = original.copy();
+		GdalImageReaderAccess::premultiplyGray8(gray8);
+		
+		for (int y = 0; y < height; ++y)
+		{
+			auto const* expected = reinterpret_cast<const QRgb*>(original.constScanLine(y));
+			auto const* actual_argb32 = reinterpret_cast<const QRgb*>(argb32.constScanLine(y));
+			auto const* actual_gray8 = reinterpret_cast<const QRgb*>(gray8.constScanLine(y));
+			for (int x = 0; x < width; ++x)
+			{
+				auto const gray = qRed(expected[x]);
+				if (actual_argb32[x] != qPremultiply(expected[x]))
+					QFAIL(qPrintable(QString::fromLatin1("ARGB32 pixel %1,%2").arg(x).arg(y)));
+				if (actual_gray8[x] != qPremultiply(qRgba(gray, gray, gray, qAlpha(expected[x]))))
+					QFAIL(qPrintable(QString::fromLatin1("Gray8 pixel %1,%2").arg(x).arg(y)));
+			}
+		}
+	}
 #endif
 	
 	void worldFilePathTest()
@@ -7,6 +7,9 @@
 
 #include "undo_manager_t.h"
 
+#include <cstddef>
+#include <memory>
+
 #include <QtTest>
 
 #include "undo/undo.h"
@@ -17,6 +20,66 @@ namespace LibreMapper { class Map; }
 using namespace LibreMapper;
 
 
+namespace {
+
+/**
+ * A NoOpUndoStep which pretends to occupy the given amount of memory.
+ * 
+ * The step returned by undo() pretends to occupy reverse_size.
+ */
+class LargeUndoStep : public NoOpUndoStep
+{
+public:
+	LargeUndoStep(Map* map, std::size_t size)
+	: LargeUndoStep(map, size, size)
+	{}
+	
+	LargeUndoStep(Map* map, std::size_t size, std::size_t reverse_size)
+	: NoOpUndoStep(map, true)
+	, size(size)
+	, reverse_size(reverse_size)
+	{}
+	
+	UndoStep* undo() override
+	{
+		return new LargeUndoStep(map, reverse_size, size);
+	}
+	
+	std::size_t memoryUsage() const override
+	{
+		return size;
+	}
+	
+private:
+	std::size_t size;
+	std::size_t reverse_size;
+};
+
+
+/**
+ * A NoOpUndoStep which counts the calls to memoryUsage().
+ */
+class CountingUndoStep : public NoOpUndoStep
+{
+public:
+	CountingUndoStep(Map* map, int& calls)
+	: NoOpUndoStep(map, true)
+	, calls(calls)
+	{}
+	
+	std::size_t memoryUsage() const override
+	{
+		++calls;
+		return NoOpUndoStep::memoryUsage();
+	}
+	
+private:
+	int& calls;
+};
+
+}  // namespace
+
+
 // test
 void UndoManagerTest::testUndoRedo()
 {
@@ -195,6 +258,49 @@ void UndoManagerTest::testUndoRedo()
 	QVERIFY(!undo_manager.canRedo());
 }
 
+void UndoManagerTest::testMemoryLimit()
+{
+	Map* const map = nullptr;
+	UndoManager undo_manager(map);
+	
+	auto const step_size = UndoManager::max_undo_memory / 3;
+	undo_manager.push(std::unique_ptr<UndoStep>(new NoOpUndoStep(map, true)));
+	for (int i = 0; i < 3; ++i)
+		undo_manager.push(std::unique_ptr<UndoStep>(new LargeUndoStep(map, step_size)));
+	QCOMPARE(undo_manager.undoStepCount(), 3);
+	
+	// The latest step is kept even if it exceeds the limit alone.
+	undo_manager.push(std::unique_ptr<UndoStep>(new LargeUndoStep(map, 2 * UndoManager::max_undo_memory)));
+	QCOMPARE(undo_manager.undoStepCount(), 1);
+	QVERIFY(undo_manager.canUndo());
+	
+	// Small steps are not limited by their number.
+	for (int i = 0; i < 1000; ++i)
+		undo_manager.push(std::unique_ptr<UndoStep>(new NoOpUndoStep(map, true)));
+	QCOMPARE(undo_manager.undoStepCount(), 1000);
+	
+	// The memory usage of each step is estimated only once.
+	int calls = 0;
+	for (int i = 0; i < 1000; ++i)
+		undo_manager.push(std::unique_ptr<UndoStep>(new CountingUndoStep(map, calls)));
+	QCOMPARE(undo_manager.undoStepCount(), 2000);
+	QCOMPARE(calls, 1000);
+	
+	// Redo steps are limited, too, dropping the farthest ones.
+	UndoManager redo_manager(map);
+	for (int i = 0; i < 3; ++i)
+		redo_manager.push(std::unique_ptr<UndoStep>(new LargeUndoStep(map, 1, UndoManager::max_undo_memory / 2)));
+	QCOMPARE(redo_manager.undoStepCount(), 3);
+	for (int i = 0; i < 3; ++i)
+		QVERIFY(redo_manager.undo());
+	QVERIFY(!redo_manager.canUndo());
+	QCOMPARE(redo_manager.redoStepCount(), 2);
+	QVERIFY(redo_manager.redo());
+	QVERIFY(redo_manager.redo());
+	QVERIFY(!redo_manager.canRedo());
+	QCOMPARE(redo_manager.undoStepCount(), 2);
+}
+
 void UndoManagerTest::resetAllChanged()
 {
 	loaded_changed   = false;
@@ -24,6 +24,11 @@ private slots:
 	 */
 	void testUndoRedo();
 	
+	/**
+	 * Tests the limitation of the memory used by undo steps.
+	 */
+	void testMemoryLimit();
+	
 private:
 	bool clean_changed;
 	bool clean;
@@ -6,12 +6,19 @@
  */
 
 
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
 #include <QtTest>
 #include <QObject>
 #include <QPointF>
 #include <QRectF>
+#include <QThread>
 
 #include "core/map_coord.h"
+#include "util/concurrency.h"
 #include "util/util.h"
 
 using namespace LibreMapper;
@@ -31,6 +38,7 @@ private slots:
 	void rectIncludeSafeTest();
 	void pointsFormCorner_data();
 	void pointsFormCorner();
+	void processConcurrentlyTest();
 };
 
 
@@ -165,5 +173,40 @@ void UtilTest::pointsFormCorner()
 }
 
 
+void UtilTest::processConcurrentlyTest()
+{
+	QCOMPARE(concurrentWorkers(0, 10), std::size_t(1));
+	QCOMPARE(concurrentWorkers(19, 10), std::size_t(1));
+	QVERIFY(concurrentWorkers(100000, 10) >= 1);
+	
+	// Each index is processed exactly once.
+	constexpr std::size_t count = 100003;
+	std::vector<std::atomic<int>> visits(count);
+	auto const num_workers = concurrentWorkers(count, 10);
+	std::atomic<bool> valid_workers { true };
+	processConcurrently(count, 10, [&](std::size_t first, std::size_t last, std::size_t worker) {
+		if (worker >= num_workers || last - first > 10)
+			valid_workers = false;
+		for (auto i = first; i < last; ++i)
+			++visits[i];
+	});
+	QVERIFY(valid_workers);
+	for (auto const& v : visits)
+		QCOMPARE(v.load(), 1);
+	
+	// Exceptions are passed to the calling thread, after all workers finished.
+	std::atomic<int> active { 0 };
+	auto failing = [&](std::size_t first, std::size_t /*last*/, std::size_t /*worker*/) {
+		++active;
+		QThread::usleep(10);
+		--active;
+		if (first == 500)
+			throw std::runtime_error("failure");
+	};
+	QVERIFY_THROWS_EXCEPTION(std::runtime_error, processConcurrently(count, 10, failing));
+	QCOMPARE(active.load(), 0);
+}
+
+
 QTEST_APPLESS_MAIN(UtilTest)
 #include "util_t.moc"  // IWYU pragma: keep